@@ -11,16 +11,49 @@ void CmdLine::common(){
           ("dmtxonly,d", "only detect the datamatrix")
           ("video-camera,C", "video from camera")
           ("video-source,s", po::value<std::string>(&video_channel_)->default_value("/dev/video1"),"video source. For example /dev/video1")
+          ("video-width", po::value<unsigned int>(&video_width_)->default_value(640),"width of the frames grabbed from the camera or read from a YUYV file")
+          ("video-height", po::value<unsigned int>(&video_height_)->default_value(480),"height of the frames grabbed from the camera or read from a YUYV file")
+          ("luma-capture", po::value<bool>(&luma_capture_)->default_value(false),
+              "grab YUYV from the camera and give the tracker its luminance directly. RGBA is only computed for display and recording")
+          ("yuyv-file", po::value<std::string>(&yuyv_file_),"file of raw YUYV frames (relative to data dir) replayed like a camera with --luma-capture")
+          ("display", po::value<bool>(&display_)->default_value(true),"show the tracked images")
+          ("async-display", po::value<bool>(&async_display_)->default_value(false),"draw overlays and flush the display on a separate thread, stale frames are dropped")
+          ("display-decimation", po::value<unsigned int>(&display_decimation_)->default_value(1),"with --async-display, show one frame out of this many")
           ("data-directory,D", po::value<std::string>(&data_dir_)->default_value("./data/"),"directory from which to load images")
           ("video-input-path,J", po::value<std::string>(&input_file_pattern_)->default_value("/images/%08d.jpg"),"input video file path relative to the data directory")
           ("video-output-path,L", po::value<std::string>(&log_file_pattern_),"output video file path relative to the data directory")
           ("single-image,I", po::value<std::string>(&single_image_name_),"load this single image (relative to data dir)")
+          ("raw-container", po::value<std::string>(&raw_container_),"raw frame container (relative to data dir) to replay instead of the image sequence. Written by pack_frames")
+          ("raw-container-format", po::value<std::string>(&raw_container_format_)->default_value("rgba"),"pixel format pack_frames stores in the raw container: gray or rgba")
+          ("shm-ring", po::value<std::string>(&shm_ring_),"name of a shared memory frame ring written by another process (see shm_producer), frames are tracked in place")
+          ("shm-slots", po::value<unsigned int>(&shm_slots_)->default_value(4),"shm_producer only. Number of frame slots of the ring, at least 2")
+          ("shm-format", po::value<std::string>(&shm_format_)->default_value("gray"),"shm_producer only. Pixel format of the ring: gray, yuyv or rgba")
+          ("shm-timeout", po::value<unsigned int>(&shm_timeout_)->default_value(1000),"time in ms to wait for a frame of the shared memory ring before ending the stream")
+          ("frame-rate", po::value<double>(&frame_rate_)->default_value(25.),"nominal frame rate of the input in fps, used to timestamp image sequences")
+          ("qos-frame-period", po::value<double>(&qos_frame_period_)->default_value(0.),
+              "target tracking time per frame in ms (40 at 25fps). When exceeded the tracker skips checkpoints, then samples fewer moving edges, then tracks at half resolution and finally drops frames. 0 disables")
+          ("prefetch-depth", po::value<unsigned int>(&prefetch_depth_)->default_value(0),"number of image sequence frames decoded ahead of the tracker, 0 to decode synchronously")
+          ("prefetch-workers", po::value<unsigned int>(&prefetch_workers_)->default_value(0),"number of threads decoding ahead, 0 for one per core")
+          ("sweep", po::value< std::vector<std::string> >(&sweep_params_)->composing(),
+              "tracking_sweep only. Parameter axis of the sweep grid: <option>=<start>:<stop>:<step> or <option>=<v1>,<v2>,... "
+              "Multi-valued options separate their values with '/', for example H=0.2/0.02,0.1/0.01")
+          ("sweep-output", po::value<std::string>(&sweep_output_)->default_value("sweep.txt"),"tracking_sweep only. Results table")
+          ("sweep-jobs", po::value<int>(&sweep_jobs_)->default_value(0),"tracking_sweep only. Number of concurrent trackers, 0 for one per core")
           ("pattern-name,P", po::value<std::string>(&pattern_name_)->default_value("pattern"),"name of xml,init and wrl files")
+          ("model-registry", po::value<std::string>(&model_registry_),
+              "index file (relative to data dir) with one \"payload config_file\" pair per line. The model tracked after a detection is the one registered for the decoded payload, --pattern-name is used for unknown payloads")
+          ("model-cache", po::value<unsigned int>(&model_cache_)->default_value(4),"number of registry models kept loaded")
           ("detector-type,r", po::value<std::string>()->default_value("zbar"),"Type of your detector that will be used for initialisation/recovery. zbar for QRcodes and more, dmtx for flashcodes.")
-          ("tracker-type,t", po::value<std::string>()->default_value("klt_mbt"),"Type of tracker. mbt_klt for hybrid: mbt+klt, mbt for model based, klt for klt-based")
+          ("tracker-type,t", po::value<std::string>()->default_value("klt_mbt"),"Type of tracker. mbt_klt for hybrid: mbt+klt, mbt for model based, klt for klt-based, klt_mbt_parallel for mbt and klt tracked on two threads and fused")
           ("verbose,v", po::value< bool >(&verbose_)->default_value(false)->composing(), "Enable or disable additional printings")
           ("dmx-detector-timeout,T", po::value<int>(&dmx_timeout_)->default_value(1000), "timeout for datamatrix detection in ms")
+          ("max-symbols", po::value<unsigned int>(&max_symbols_)->default_value(1),
+              "number of datamatrix symbols to look for in one scan, the tracker starts on the best one. zbar always reports all the QR codes it finds")
+          ("frame-budget", po::value<double>(&frame_budget_)->default_value(0.),
+              "time budget of a frame in ms shared by conversion, detection, model initialisation and tracking. Time unused by tracked frames is lent to the detector. 0 disables")
           ("config-file,c", po::value<std::string>(&config_file)->default_value("./data/config.cfg"), "config file for the program")
+          ("config-watch-period", po::value<unsigned int>(&config_watch_period_)->default_value(0),
+              "check the config file every this many ms and apply changes of the tuning options (R, l, H, Y, w, T, S, fast-recovery-steps) to the running tracker, without reloading the model. 0 disables")
           ("show-fps,f", po::value< bool >(&show_fps_)->default_value(false)->composing(), "show framerate")
           ("show-plot,p", po::value< bool >(&show_plot_)->default_value(false)->composing(), "show variances graph")
 
@@ -42,10 +75,36 @@ void CmdLine::common(){
           ("variance-limit,l", po::value< double >(&var_limit_)->composing(),
               "above this limit the tracker will be considered lost and the pattern will be detected with the flascode")
           ("mbt-convergence-steps,S", po::value< int >(&mbt_convergence_steps_)->default_value(1)->composing(),
-              "when a new model is detected, how many tracking iterations should the tracker perform so the model matches the projection.")
+              "when a new model is detected, how many tracking iterations should the tracker perform so the model matches the projection. Upper bound when a convergence threshold is set")
+          ("convergence-threshold",
+                            po::value< std::vector<double> >(&convergence_threshold_)->multitoken()->composing(),
+                            "pair of translation (m), rotation (rad) values. Model initialisation stops as soon as one tracking iteration moves the pose less than that")
+          ("convergence-residual", po::value< double >(&convergence_residual_)->composing(),
+              "model initialisation stops only once the RMS of the tracker residual is below this value")
           ("hinkley-range,H",
                             po::value< std::vector<double> >(&hinkley_range_)->multitoken()->composing(),
                             "pair of alpha, delta values describing the two hinkley tresholds")
+          ("cusum",
+                            po::value< std::vector<double> >(&cusum_)->multitoken()->composing(),
+                            "pair of k, h values of a cusum test on the sum of the pose variances normalised by its initial mean. k is the allowed slack, h the decision threshold")
+          ("ewma",
+                            po::value< std::vector<double> >(&ewma_)->multitoken()->composing(),
+                            "pair of lambda, L values of an exponentially weighted average of the sum of the pose variances. Drift is reported above L standard deviations")
+          ("pose-jump",
+                            po::value< std::vector<double> >(&pose_jump_)->multitoken()->composing(),
+                            "pair of translation (m), rotation (rad) values. Tracking is lost when the pose moves more than that between two frames")
+          ("checkpoint-period", po::value< unsigned int >(&checkpoint_period_)->default_value(1)->composing(),
+              "ad-hoc recovery checkpoints are checked every this many frames, or as soon as cusum or ewma report drift")
+          ("mbt-decimation", po::value< unsigned int >(&mbt_decimation_)->default_value(1)->composing(),
+              "track on the image subsampled by this factor with scaled camera parameters. The model is still initialised at full resolution")
+          ("refine-variance", po::value< double >(&refine_variance_)->composing(),
+              "with --mbt-decimation, track the full resolution image again when a pose variance goes above this value")
+          ("roi-margin", po::value< int >(&roi_margin_)->composing(),
+              "while tracking, only convert to gray the pixels around the model projected at the previous pose, dilated by the moving edge range, the klt window and this many more pixels for the motion between frames")
+          ("fast-recovery-steps", po::value< unsigned int >(&fast_recovery_steps_)->default_value(0)->composing(),
+              "once per loss, track this many times from the last good pose moved at constant velocity and resume tracking if the quality tests pass, before looking for the flashcode. 0 disables")
+          ("klt-warm-restart", po::value< unsigned int >(&klt_warm_restart_)->default_value(0)->composing(),
+              "klt and klt_mbt trackers: when the model is detected again within this many frames of a loss, keep the klt features that are still valid at the new pose and only extract missing ones instead of resetting the tracker. 0 disables")
           ("mbt-dynamic-range,R", po::value< double >(&mbt_dynamic_range_)->composing(),
                     "Adapt mbt range to symbol size. The width of the outer black corner is multiplied by this value to get the mbt range. Try 0.2")
           ("ad-hoc-recovery,W", po::value< bool >(&adhoc_recovery_)->default_value(true)->composing(), "Enable or disable ad-hoc recovery")
@@ -62,9 +121,19 @@ void CmdLine::common(){
       prog_args.add(general);
       prog_args.add(configuration);
 }
+void CmdLine::store(po::parsed_options parsed){
+  //drop overridden options so that the overriding value is the only one stored
+  std::vector<po::option> kept;
+  for(std::vector<po::option>::iterator i = parsed.options.begin();i!=parsed.options.end();i++)
+    if(overridden_.count(i->string_key)==0)
+      kept.push_back(*i);
+  parsed.options.swap(kept);
+  po::store(parsed, vm_);
+}
+
 void CmdLine::loadConfig(std::string& config_file){
   std::ifstream in( config_file.c_str() );
-  po::store(po::parse_config_file(in,prog_args,false), vm_);
+  store(po::parse_config_file(in,prog_args,false));
   po::notify(vm_);
   in.close();
 
@@ -96,6 +165,9 @@ void CmdLine::loadConfig(std::string& config_file){
         case KLT_MBT:
           std::cout << "hybrid (mbt+klt)";
           break;
+        case KLT_MBT_PARALLEL:
+          std::cout << "parallel hybrid (mbt|klt fused)";
+          break;
         case KLT:
           std::cout << "tracker with klt points";
           break;
@@ -142,6 +214,21 @@ CmdLine:: CmdLine(int argc,char**argv) : should_exit_(false) {
 
 }
 
+CmdLine:: CmdLine(int argc,char**argv,const std::vector<std::string>& overrides) : should_exit_(false) {
+  common();
+
+  po::parsed_options forced = po::command_line_parser(overrides).options(prog_args).run();
+  po::store(forced, vm_);
+  for(std::vector<po::option>::iterator i = forced.options.begin();i!=forced.options.end();i++)
+    overridden_.insert(i->string_key);
+  store(po::parse_command_line(argc, argv, prog_args));
+  po::notify(vm_);
+  if(get_verbose())
+    std::cout << "Loading config from:" << config_file.c_str() << std::endl;
+
+  loadConfig(config_file);
+}
+
 vpCameraParameters CmdLine::get_cam_calib_params() const{
   vpCameraParameters cam;
   vpMbEdgeTracker tmptrack;
@@ -178,10 +265,114 @@ double CmdLine:: get_hinkley_delta() const{
   return hinkley_range_[1];
 }
 
+bool CmdLine:: using_cusum() const{
+  return vm_.count("cusum")>0 && cusum_.size()==2;
+}
+
+double CmdLine:: get_cusum_k() const{
+  if(!using_cusum())
+    throw std::exception();
+  return cusum_[0];
+}
+
+double CmdLine:: get_cusum_h() const{
+  if(!using_cusum())
+    throw std::exception();
+  return cusum_[1];
+}
+
+bool CmdLine:: using_ewma() const{
+  return vm_.count("ewma")>0 && ewma_.size()==2;
+}
+
+double CmdLine:: get_ewma_lambda() const{
+  if(!using_ewma())
+    throw std::exception();
+  return ewma_[0];
+}
+
+double CmdLine:: get_ewma_width() const{
+  if(!using_ewma())
+    throw std::exception();
+  return ewma_[1];
+}
+
+bool CmdLine:: using_pose_jump() const{
+  return vm_.count("pose-jump")>0 && pose_jump_.size()==2;
+}
+
+double CmdLine:: get_pose_jump_translation() const{
+  if(!using_pose_jump())
+    throw std::exception();
+  return pose_jump_[0];
+}
+
+double CmdLine:: get_pose_jump_rotation() const{
+  if(!using_pose_jump())
+    throw std::exception();
+  return pose_jump_[1];
+}
+
+unsigned int CmdLine:: get_checkpoint_period() const{
+  return checkpoint_period_;
+}
+
+bool CmdLine:: using_convergence_threshold() const{
+  return vm_.count("convergence-threshold")>0 && convergence_threshold_.size()==2;
+}
+
+double CmdLine:: get_convergence_translation() const{
+  if(!using_convergence_threshold())
+    throw std::exception();
+  return convergence_threshold_[0];
+}
+
+double CmdLine:: get_convergence_rotation() const{
+  if(!using_convergence_threshold())
+    throw std::exception();
+  return convergence_threshold_[1];
+}
+
+bool CmdLine:: using_convergence_residual() const{
+  return vm_.count("convergence-residual")>0;
+}
+
+double CmdLine:: get_convergence_residual() const{
+  return convergence_residual_;
+}
+
 int CmdLine:: get_mbt_convergence_steps() const{
   return mbt_convergence_steps_;
 }
 
+unsigned int CmdLine:: get_mbt_decimation() const{
+  return mbt_decimation_;
+}
+
+bool CmdLine:: using_refine_variance() const{
+  return vm_.count("refine-variance")>0;
+}
+
+double CmdLine:: get_refine_variance() const{
+  return refine_variance_;
+}
+
+bool CmdLine:: using_roi_margin() const{
+  return vm_.count("roi-margin")>0;
+}
+
+int CmdLine:: get_roi_margin() const{
+  return roi_margin_;
+}
+
+unsigned int CmdLine:: get_fast_recovery_steps() const{
+  return fast_recovery_steps_;
+}
+
+unsigned int CmdLine:: get_klt_warm_restart() const{
+  return klt_warm_restart_;
+}
+
 double CmdLine:: get_mbt_dynamic_range() const{
   return mbt_dynamic_range_;
 }
@@ -234,6 +425,10 @@ int CmdLine:: get_dmx_timeout() const{
   return dmx_timeout_;
 }
 
+unsigned int CmdLine:: get_max_symbols() const{
+  return max_symbols_;
+}
+
 double CmdLine:: get_inner_ratio() const{
   return inner_ratio_;
 }
@@ -258,6 +453,26 @@ std::string CmdLine:: get_pattern_name() const{
   return pattern_name_;
 }
 
+bool CmdLine:: using_model_registry() const{
+  return vm_.count("model-registry")>0;
+}
+
+std::string CmdLine:: get_model_registry() const{
+  return get_data_dir() + model_registry_;
+}
+
+std::string CmdLine:: get_config_file() const{
+  return config_file;
+}
+
+unsigned int CmdLine:: get_config_watch_period() const{
+  return config_watch_period_;
+}
+
+unsigned int CmdLine:: get_model_cache() const{
+  return model_cache_;
+}
+
 std::string CmdLine:: get_wrl_file() const{
   return get_data_dir() + get_pattern_name() + std::string(".wrl");
 }
@@ -278,6 +493,114 @@ std::string CmdLine:: get_single_image_path() const{
   return get_data_dir() + single_image_name_;
 }
 
+bool CmdLine:: using_raw_container() const{
+  return vm_.count("raw-container")>0;
+}
+
+unsigned int CmdLine:: get_video_width() const{
+  return video_width_;
+}
+
+unsigned int CmdLine:: get_video_height() const{
+  return video_height_;
+}
+
+bool CmdLine:: using_luma_capture() const{
+  return luma_capture_;
+}
+
+bool CmdLine:: using_yuyv_file() const{
+  return vm_.count("yuyv-file")>0;
+}
+
+std::string CmdLine:: get_yuyv_file_path() const{
+  return get_data_dir() + yuyv_file_;
+}
+
+bool CmdLine:: show_display() const{
+  return display_;
+}
+
+bool CmdLine:: using_async_display() const{
+  return display_ && async_display_;
+}
+
+unsigned int CmdLine:: get_display_decimation() const{
+  return display_decimation_;
+}
+
+std::string CmdLine:: get_raw_container_path() const{
+  return get_data_dir() + raw_container_;
+}
+
+bool CmdLine:: raw_container_gray() const{
+  return raw_container_format_ == "gray";
+}
+
+bool CmdLine:: using_shm_ring() const{
+  return vm_.count("shm-ring")>0;
+}
+
+std::string CmdLine:: get_shm_ring() const{
+  return shm_ring_;
+}
+
+unsigned int CmdLine:: get_shm_slots() const{
+  return shm_slots_;
+}
+
+std::string CmdLine:: get_shm_format() const{
+  return shm_format_;
+}
+
+unsigned int CmdLine:: get_shm_timeout() const{
+  return shm_timeout_;
+}
+
+double CmdLine:: get_frame_rate() const{
+  return frame_rate_;
+}
+
+bool CmdLine:: using_frame_budget() const{
+  return frame_budget_>0.;
+}
+
+double CmdLine:: get_frame_budget() const{
+  return frame_budget_;
+}
+
+bool CmdLine:: using_qos() const{
+  return qos_frame_period_>0.;
+}
+
+double CmdLine:: get_qos_frame_period() const{
+  return qos_frame_period_;
+}
+
+bool CmdLine:: using_prefetch() const{
+  return prefetch_depth_>0;
+}
+
+unsigned int CmdLine:: get_prefetch_depth() const{
+  return prefetch_depth_;
+}
+
+unsigned int CmdLine:: get_prefetch_workers() const{
+  return prefetch_workers_;
+}
+
+const std::vector<std::string>& CmdLine:: get_sweep_params() const{
+  return sweep_params_;
+}
+
+std::string CmdLine:: get_sweep_output() const{
+  return sweep_output_;
+}
+
+int CmdLine:: get_sweep_jobs() const{
+  return sweep_jobs_;
+}
+
 std::vector<vpPoint>& CmdLine:: get_flashcode_points_3D() {
   return flashcode_points_3D_;
 }
@@ -302,6 +625,8 @@ CmdLine::TRACKER_TYPE CmdLine:: get_tracker_type() const{
     return CmdLine::MBT;
   else if(vm_["tracker-type"].as<std::string>()=="klt")
     return CmdLine::KLT;
+  else if(vm_["tracker-type"].as<std::string>()=="klt_mbt_parallel")
+    return CmdLine::KLT_MBT_PARALLEL;
   else
     return CmdLine::KLT_MBT;
 }
@@ -6,6 +6,7 @@
 #include <boost/program_options/parsers.hpp>
 #include <exception>
 #include <string>
+#include <set>
 #include <visp/vpConfig.h>
 #include <visp/vpPoint.h>
 namespace po = boost::program_options;
@@ -18,6 +19,13 @@ class CmdLine{
   bool log_pose_;
   bool should_exit_;
   std::string video_channel_;
+  unsigned int video_width_;
+  unsigned int video_height_;
+  bool luma_capture_;
+  std::string yuyv_file_;
+  bool display_;
+  bool async_display_;
+  unsigned int display_decimation_;
   double inner_ratio_;
   double outer_ratio_;
   double var_limit_;
@@ -27,13 +35,43 @@ class CmdLine{
   unsigned int adhoc_recovery_treshold_;
   double adhoc_recovery_size_;
   std::vector<double> hinkley_range_;
+  std::vector<double> cusum_;
+  std::vector<double> ewma_;
+  std::vector<double> pose_jump_;
+  unsigned int checkpoint_period_;
   int dmx_timeout_;
+  unsigned int max_symbols_;
+  double frame_budget_;
   int mbt_convergence_steps_;
+  std::vector<double> convergence_threshold_;
+  double convergence_residual_;
   double mbt_dynamic_range_;
+  unsigned int mbt_decimation_;
+  double refine_variance_;
+  unsigned int klt_warm_restart_;
+  unsigned int fast_recovery_steps_;
+  int roi_margin_;
   std::string data_dir_;
   std::string pattern_name_;
+  std::string model_registry_;
+  unsigned int model_cache_;
+  unsigned int config_watch_period_;
   std::string var_file_;
   std::string single_image_name_;
+  std::string raw_container_;
+  std::string raw_container_format_;
+  std::string shm_ring_;
+  unsigned int shm_slots_;
+  std::string shm_format_;
+  unsigned int shm_timeout_;
+  double frame_rate_;
+  double qos_frame_period_;
+  unsigned int prefetch_depth_;
+  unsigned int prefetch_workers_;
+  std::vector<std::string> sweep_params_;
+  std::string sweep_output_;
+  int sweep_jobs_;
+  std::set<std::string> overridden_;
   std::vector<vpPoint> flashcode_points_3D_;
   std::vector<vpPoint> inner_points_3D_,outer_points_3D_;
 
@@ -43,15 +81,18 @@ class CmdLine{
   std::string config_file;
   void loadConfig(std::string& config_file);
   void common();
+  void store(po::parsed_options parsed);
  public:
   enum DETECTOR_TYPE{
     DMTX, ZBAR
   };
   enum TRACKER_TYPE{
-    KLT, MBT, KLT_MBT
+    KLT, MBT, KLT_MBT, KLT_MBT_PARALLEL
   };
 
   CmdLine(int argc,char**argv);
+  //same as above but options given in overrides replace those of the command line and config file
+  CmdLine(int argc,char**argv,const std::vector<std::string>& overrides);
   CmdLine(std::string& config_file);
 
   bool show_plot() const;
@@ -64,6 +105,26 @@ class CmdLine{
 
   double get_hinkley_delta() const;
 
+  bool using_cusum() const;
+
+  double get_cusum_k() const;
+
+  double get_cusum_h() const;
+
+  bool using_ewma() const;
+
+  double get_ewma_lambda() const;
+
+  double get_ewma_width() const;
+
+  bool using_pose_jump() const;
+
+  double get_pose_jump_translation() const;
+
+  double get_pose_jump_rotation() const;
+
+  unsigned int get_checkpoint_period() const;
+
   bool dmtx_only() const;
 
   bool should_exit() const;
@@ -78,8 +139,32 @@ class CmdLine{
 
   int get_mbt_convergence_steps() const;
 
+  bool using_convergence_threshold() const;
+
+  double get_convergence_translation() const;
+
+  double get_convergence_rotation() const;
+
+  bool using_convergence_residual() const;
+
+  double get_convergence_residual() const;
+
   double get_mbt_dynamic_range() const;
 
+  unsigned int get_mbt_decimation() const;
+
+  bool using_refine_variance() const;
+
+  double get_refine_variance() const;
+
+  unsigned int get_klt_warm_restart() const;
+
+  unsigned int get_fast_recovery_steps() const;
+
+  bool using_roi_margin() const;
+
+  int get_roi_margin() const;
+
   double get_adhoc_recovery_size() const;
 
   bool log_checkpoints() const;
@@ -92,6 +177,8 @@ class CmdLine{
 
   int get_dmx_timeout() const;
 
+  unsigned int get_max_symbols() const;
+
   double get_inner_ratio() const;
 
   double get_outer_ratio() const;
@@ -104,6 +191,16 @@ class CmdLine{
 
   std::string get_pattern_name() const;
 
+  bool using_model_registry() const;
+
+  std::string get_model_registry() const;
+
+  unsigned int get_model_cache() const;
+
+  std::string get_config_file() const;
+
+  unsigned int get_config_watch_period() const;
+
   std::string get_wrl_file() const;
 
   std::string get_xml_file() const;
@@ -131,6 +228,60 @@ class CmdLine{
 
   std::string get_single_image_path() const;
 
+  unsigned int get_video_width() const;
+
+  unsigned int get_video_height() const;
+
+  bool using_luma_capture() const;
+
+  bool using_yuyv_file() const;
+
+  std::string get_yuyv_file_path() const;
+
+  bool show_display() const;
+
+  bool using_async_display() const;
+
+  unsigned int get_display_decimation() const;
+
+  bool using_raw_container() const;
+
+  std::string get_raw_container_path() const;
+
+  bool raw_container_gray() const;
+
+  bool using_shm_ring() const;
+
+  std::string get_shm_ring() const;
+
+  unsigned int get_shm_slots() const;
+
+  std::string get_shm_format() const;
+
+  unsigned int get_shm_timeout() const;
+
+  double get_frame_rate() const;
+
+  bool using_frame_budget() const;
+
+  double get_frame_budget() const;
+
+  bool using_qos() const;
+
+  double get_qos_frame_period() const;
+
+  bool using_prefetch() const;
+
+  unsigned int get_prefetch_depth() const;
+
+  unsigned int get_prefetch_workers() const;
+
+  const std::vector<std::string>& get_sweep_params() const;
+
+  std::string get_sweep_output() const;
+
+  int get_sweep_jobs() const;
+
   std::vector<vpPoint>& get_flashcode_points_3D();
   std::vector<vpPoint>& get_inner_points_3D();
   std::vector<vpPoint>& get_outer_points_3D();
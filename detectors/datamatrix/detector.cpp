@@ -1,5 +1,6 @@
 #include "detector.h"
 #include <dmtx.h>
+#include <cstdlib>
 
 namespace detectors{
 namespace datamatrix{
@@ -7,82 +8,47 @@ namespace datamatrix{
   }
 
   bool Detector::detect(cv::Mat& image, int timeout, unsigned int offsetx, unsigned int offsety){
-    bool detected = false;
-    lines_.clear();
-    message_.clear();
-    polygon_.clear();
+    clear();
     DmtxRegion     *reg;
     DmtxDecode     *dec;
     DmtxImage      *img;
     DmtxMessage    *msg;
     DmtxTime       t;
 
-    img = dmtxImageCreate(image.data, image.cols, image.rows, DmtxPack24bppRGB);
+    img = dmtxImageCreate(image.data, image.cols, image.rows, image.channels()==1 ? DmtxPack8bppK : DmtxPack24bppRGB);
     //dmtxImageSetProp(img, DmtxPropImageFlip, DmtxFlipY);
 
     dec = dmtxDecodeCreate(img, 1);
     assert(dec != NULL);
 
+    //all regions share the same deadline, the scan resumes where the previous region was found
     t = dmtxTimeAdd(dmtxTimeNow(), timeout);
-    reg = dmtxRegionFindNext(dec, &t);
-
-    if(reg != NULL) {
-
-      int height;
-      int dataWordLength;
-      int rotateInt;
-      double rotate;
-      DmtxVector2 p00, p10, p11, p01;
-
-      height = dmtxDecodeGetProp(dec, DmtxPropHeight);
-
-      p00.X = p00.Y = p10.Y = p01.X = 0.0;
-      p10.X = p01.Y = p11.X = p11.Y = 1.0;
-      dmtxMatrix3VMultiplyBy(&p00, reg->fit2raw);
-      dmtxMatrix3VMultiplyBy(&p10, reg->fit2raw);
-      dmtxMatrix3VMultiplyBy(&p11, reg->fit2raw);
-      dmtxMatrix3VMultiplyBy(&p01, reg->fit2raw);
-      polygon_.push_back(cv::Point(p00.X + offsetx,image.rows-p00.Y + offsety));
-      polygon_.push_back(cv::Point(p10.X + offsetx,image.rows-p10.Y + offsety));
-      polygon_.push_back(cv::Point(p11.X + offsetx,image.rows-p11.Y + offsety));
-      polygon_.push_back(cv::Point(p01.X + offsetx,image.rows-p01.Y + offsety));
+    while(symbols_.size()<max_symbols_ && (reg = dmtxRegionFindNext(dec, &t)) != NULL) {
+      DmtxVector2 p[4];
+
+      p[0].X = p[0].Y = p[1].Y = p[3].X = 0.0;
+      p[1].X = p[3].Y = p[2].X = p[2].Y = 1.0;
+      symbol_t found;
+      for(unsigned int i=0;i<4;i++){
+        dmtxMatrix3VMultiplyBy(&p[i], reg->fit2raw);
+        found.corners[i] = cv::Point(p[i].X + offsetx,image.rows-p[i].Y + offsety);
+      }
 
-      lines_.push_back(
-                       std::pair<cv::Point,cv::Point>(
-                                                      cv::Point(p00.X + offsetx,image.rows-p00.Y + offsety),
-                                                      cv::Point(p10.X + offsetx,image.rows-p10.Y + offsety)
-                                                      )
-                       );
-      lines_.push_back(
-                             std::pair<cv::Point,cv::Point>(
-                                                            cv::Point(p10.X + offsetx,image.rows-p10.Y + offsety),
-                                                            cv::Point(p11.X + offsetx,image.rows-p11.Y + offsety)
-                                                            )
-                             );
-      lines_.push_back(
-                             std::pair<cv::Point,cv::Point>(
-                                                            cv::Point(p11.X + offsetx,image.rows-p11.Y + offsety),
-                                                            cv::Point(p01.X + offsetx,image.rows-p01.Y + offsety)
-                                                            )
-                             );
-      lines_.push_back(
-                             std::pair<cv::Point,cv::Point>(
-                                                            cv::Point(p01.X + offsetx,image.rows-p01.Y + offsety),
-                                                            cv::Point(p00.X + offsetx,image.rows-p00.Y + offsety)
-                                                            )
-                             );
-      detected = true;
+      //contrast between modules, an undecodable region is kept but ranks last
+      found.quality = 0.;
       msg = dmtxDecodeMatrixRegion(dec, reg, DmtxUndefined);
       if(msg != NULL) {
-        message_ = (const char*)msg->output;
+        found.payload = (const char*)msg->output;
+        found.quality = std::abs(reg->onColor-reg->offColor)/255.;
         dmtxMessageDestroy(&msg);
       }
+      symbols_.push_back(found);
       dmtxRegionDestroy(&reg);
     }
-      
+
     dmtxDecodeDestroy(&dec);
     dmtxImageDestroy(&img);
-    return detected;
+    return select_best();
   }
 }
 }
@@ -1,7 +1,33 @@
 #include "detector_base.h"
+#include <algorithm>
 
 namespace detectors{
-std::vector<std::pair<cv::Point,cv::Point> >& DetectorBase:: get_lines(){
+DetectorBase:: DetectorBase() : max_symbols_(1){
+}
+
+void DetectorBase:: clear(){
+  lines_.clear();
+  polygon_.clear();
+  message_.clear();
+  symbols_.clear();
+}
+
+bool DetectorBase:: select_best(){
+  if(symbols_.empty())
+    return false;
+  std::vector<symbol_t>::const_iterator best = symbols_.begin();
+  for(std::vector<symbol_t>::const_iterator i = symbols_.begin();i!=symbols_.end();i++)
+    if(i->quality>best->quality)
+      best = i;
+  message_ = best->payload;
+  for(unsigned int i=0;i<4;i++){
+    polygon_.push_back(best->corners[i]);
+    lines_.push_back(std::pair<cv::Point,cv::Point>(best->corners[i],best->corners[(i+1)%4]));
+  }
+  return true;
+}
+
+const lines_t& DetectorBase:: get_lines() const{
   return lines_;
 }
 
@@ -9,9 +35,17 @@ std::string& DetectorBase:: get_message(){
   return message_;
 }
 
-std::vector<cv::Point>& DetectorBase:: get_polygon(){
+const polygon_t& DetectorBase:: get_polygon() const{
   return polygon_;
 }
+
+const std::vector<symbol_t>& DetectorBase:: get_symbols() const{
+  return symbols_;
+}
+
+void DetectorBase:: set_max_symbols(unsigned int max_symbols){
+  max_symbols_ = std::max(max_symbols,1u);
+}
 }
 
 
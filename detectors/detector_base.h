@@ -5,27 +5,73 @@
 #include <vector>
 #include <utility>
 #include <string>
+#include <cassert>
 
 namespace detectors{
+  //sequence of at most N elements stored in place
+  template <class T, unsigned int N>
+  class fixed_vector{
+  private:
+    T items_[N];
+    unsigned int size_;
+  public:
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    fixed_vector() : size_(0){}
+    void clear(){ size_ = 0; }
+    void push_back(const T& item){ assert(size_<N); items_[size_++] = item; }
+    unsigned int size() const{ return size_; }
+    bool empty() const{ return size_==0; }
+    T& operator[](unsigned int i){ return items_[i]; }
+    const T& operator[](unsigned int i) const{ return items_[i]; }
+    iterator begin(){ return items_; }
+    iterator end(){ return items_+size_; }
+    const_iterator begin() const{ return items_; }
+    const_iterator end() const{ return items_+size_; }
+  };
+
+  //container box of a pattern, as its 4 corners or its 4 sides
+  typedef fixed_vector<cv::Point,4> polygon_t;
+  typedef fixed_vector<std::pair<cv::Point,cv::Point>,4> lines_t;
+
+  //one pattern found by a scan pass
+  struct symbol_t{
+    std::string payload; //only written by detection frames, the decoders allocate there anyway
+    cv::Point corners[4];
+    double quality; //in [0,1], higher is better. Only comparable between symbols of the same detector
+  };
+
   class DetectorBase{
   protected:
-    std::vector<std::pair<cv::Point,cv::Point> > lines_;
-    std::vector<cv::Point> polygon_;
+    lines_t lines_;
+    polygon_t polygon_;
     std::string message_;
+    std::vector<symbol_t> symbols_;
+    unsigned int max_symbols_;
+    //forgets the results of the previous scan
+    void clear();
+    //fills polygon_, lines_ and message_ from the best symbol, returns false if there is none
+    bool select_best();
   public:
+    DetectorBase();
+    virtual ~DetectorBase(){}
     /*
      * detect pattern in image
-     * image: image where to detect pattern
+     * image: image where to detect pattern, BGR or gray
      * timeout: maximum time for pattern detection
      * offset: offset container box by that much pixels
      * */
     virtual bool detect(cv::Mat& image, int timeout=1000, unsigned int offsetx=0, unsigned int offsety=0) = 0;
     //returns pattern container box as a vector of lines
-    std::vector<std::pair<cv::Point,cv::Point> >& get_lines();
+    const lines_t& get_lines() const;
     //returns the contained message if there is one
     std::string& get_message();
     //returns pattern container box as a vector of points
-    std::vector<cv::Point>& get_polygon();
+    const polygon_t& get_polygon() const;
+    //returns every symbol found by the last scan, the best one is also given by get_polygon/get_message
+    const std::vector<symbol_t>& get_symbols() const;
+    //stop scanning after this many symbols, 1 by default. Detectors that find all symbols in one pass ignore it
+    void set_max_symbols(unsigned int max_symbols);
   };
 }
 #endif
@@ -13,6 +13,7 @@ namespace qrcode{
   class Detector : public DetectorBase{
   private:
     zbar::ImageScanner scanner_;
+    cv::Mat gray_; //kept across calls to reuse its buffer
   public:
     Detector();
     bool detect(cv::Mat& image, int timeout=1000, unsigned int offsetx = 0, unsigned int offsety = 0);
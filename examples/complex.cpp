@@ -9,6 +9,19 @@
 #include "libauto_tracker/tracking.h"
 #include "libauto_tracker/threading.h"
 #include "libauto_tracker/events.h"
+#include "libauto_tracker/parallel_hybrid.h"
+#include "libauto_tracker/display_thread.h"
+#include "libauto_tracker/model_registry.h"
+#include "libauto_tracker/config_watcher.h"
+
+//sources
+#include "sources/raw/source.h"
+#include "sources/prefetch/source.h"
+#include "sources/yuyv/file_source.h"
+#include "sources/shm/source.h"
+#ifdef __linux__
+#include "sources/yuyv/v4l2_source.h"
+#endif
 
 //visp includes
 #include <visp/vpImageIo.h>
@@ -34,6 +47,11 @@ int main(int argc, char**argv)
   vpVideoWriter writer;
   vpImage<vpRGBa> logI;
   vpMbTracker* tracker;
+  sources::SourceBase* source = NULL;
+  //sources able to hand the tracker luminance without going through RGBA
+  sources::LumaSourceBase* luma_source = NULL;
+  sources::shm::Source* shm_source = NULL;
+  vpImage<unsigned char> Y;
 
   vpCameraParameters cam = cmd.get_cam_calib_params();
   if(cmd.get_verbose())
@@ -49,34 +67,71 @@ int main(int argc, char**argv)
     if(cmd.get_verbose())
       std::cout << "Loading: " << cmd.get_single_image_path() << std::endl;
     vpImageIo::read(I,cmd.get_single_image_path());
+  }else if(cmd.using_yuyv_file()){
+    if(cmd.get_verbose())
+      std::cout << "Replaying YUYV: " << cmd.get_yuyv_file_path() << std::endl;
+    source = luma_source = new sources::yuyv::FileSource(cmd.get_yuyv_file_path(),cmd.get_video_width(),cmd.get_video_height(),cmd.get_frame_rate());
+    source->open(I);
+#ifdef __linux__
+  }else if(cmd.using_video_camera() && cmd.using_luma_capture()){
+    source = luma_source = new sources::yuyv::V4l2Source(cmd.get_video_channel(),cmd.get_video_width(),cmd.get_video_height(),3);
+    source->open(I);
+#endif
   }else if(cmd.using_video_camera()){
     video_reader.setDevice(cmd.get_video_channel().c_str());
     video_reader.setInput(0);
     video_reader.setScale(1);
     video_reader.setFramerate(vpV4l2Grabber::framerate_25fps); //  25 fps
     video_reader.setPixelFormat(vpV4l2Grabber::V4L2_YUYV_FORMAT);
-    video_reader.setWidth(640);
-    video_reader.setHeight(480);
+    video_reader.setWidth(cmd.get_video_width());
+    video_reader.setHeight(cmd.get_video_height());
     video_reader.setNBuffers(3); // 3 ring buffers to ensure real-time acquisition
     video_reader.open(I);        // Open the grabber
+  }else if(cmd.using_shm_ring()){
+    if(cmd.get_verbose())
+      std::cout << "Attaching to shared memory ring: " << cmd.get_shm_ring() << std::endl;
+    source = shm_source = new sources::shm::Source(cmd.get_shm_ring(),cmd.get_shm_timeout()); //frames are tracked in the ring, no copy
+    //gray and yuyv rings hand the tracker their luminance
+    if(shm_source->get_format() != sources::shm::FORMAT_RGBA)
+      luma_source = shm_source;
+    source->open(I);
+  }else if(cmd.using_raw_container()){
+    if(cmd.get_verbose())
+      std::cout << "Replaying: " << cmd.get_raw_container_path() << std::endl;
+    sources::raw::Source* raw_source = new sources::raw::Source(cmd.get_raw_container_path()); //frames are views on the mapped file, no copy
+    source = raw_source;
+    //gray containers hand the tracker their frames, RGBA is only built for display
+    if(raw_source->get_format() == sources::raw::FORMAT_GRAY)
+      luma_source = raw_source;
+    source->open(I);
   }else{
     std::string filenames((cmd.get_data_dir() + cmd.get_input_file_pattern()));
     if(cmd.get_verbose())
       std::cout << "Loading: " << filenames << std::endl;
-    reader.setFileName( filenames.c_str() );
-
-    reader.setFirstFrameIndex(2);
-    reader.open(I);
+    if(cmd.using_prefetch()){
+      source = new sources::prefetch::Source(filenames,2,cmd.get_prefetch_depth(),cmd.get_prefetch_workers(),cmd.get_frame_rate());
+      source->open(I);
+    }else{
+      reader.setFileName( filenames.c_str() );
+
+      reader.setFirstFrameIndex(2);
+      reader.open(I);
+    }
   }
 
-  //init display
-  vpDisplayX* d = new vpDisplayX();
-  d->init(I);
+  //init display, with --async-display the window belongs to the display thread
+  vpDisplayX* d = NULL;
+  if(cmd.show_display() && !cmd.using_async_display()){
+    d = new vpDisplayX();
+    d->init(I);
+  }
+  //with a luma source RGBA is only needed to show or record frames
+  bool need_rgba = cmd.show_display() || cmd.logging_video();
   //init hybrid tracker
   detectors::DetectorBase* detector = NULL;
   if (cmd.get_detector_type() == CmdLine::ZBAR)
     detector = new detectors::qrcode::Detector;
-  else if(cmd.get_detector_type() == CmdLine::DTMX)
+  else if(cmd.get_detector_type() == CmdLine::DMTX)
     detector = new detectors::datamatrix::Detector;
 
   if(cmd.get_tracker_type() == CmdLine::KLT)
@@ -85,8 +140,25 @@ int main(int argc, char**argv)
     tracker = new vpMbEdgeKltTracker();
   else if(cmd.get_tracker_type() == CmdLine::MBT)
     tracker = new vpMbEdgeTracker();
-
-  tracking::Tracker t(cmd,detector,tracker);
+  else if(cmd.get_tracker_type() == CmdLine::KLT_MBT_PARALLEL)
+    tracker = new tracking::ParallelHybridTracker();
+
+  tracking::DisplayThread display(cmd,cmd.get_display_decimation());
+  tracking::ModelRegistry registry(cmd,cmd.get_model_cache());
+  tracking::Tracker t(cmd,detector,tracker,d!=NULL);
+  if(cmd.using_model_registry()){
+    unsigned int entries = registry.load_index(cmd.get_model_registry());
+    if(cmd.get_verbose())
+      std::cout << "model registry: " << entries << " payloads" << std::endl;
+    t.set_model_registry(&registry);
+  }
+  if(cmd.using_async_display()){
+    t.set_display_thread(&display);
+    display.start();
+  }
+  tracking::ConfigWatcher watcher(t,cmd.get_config_file(),cmd.get_config_watch_period(),cmd.get_verbose());
+  if(cmd.get_config_watch_period()>0)
+    watcher.start();
   TrackerThread tt(t);
   boost::thread bt(tt);
 
@@ -96,29 +168,70 @@ int main(int argc, char**argv)
   //The first meaningful frame is selected with a click
   //In other cases, the first meaningful frame is selected by sending
   //the tracking::select_input event
-  if(!cmd.using_video_camera())
+  if(!cmd.using_video_camera() || !d)
     t.process_event(tracking::select_input(I));
 
 
   for(int iter=0;
       cmd.using_video_camera() ||
       cmd.using_single_image() ||
+      source ||
       (iter<reader.getLastFrameIndex()-1);
       iter++
       ){
+    double timestamp = vpTime::measureTimeMs();
+    if(luma_source){
+      if(!luma_source->acquire(Y))
+        break;
+      timestamp = luma_source->get_timestamp();
+      if(need_rgba)
+        luma_source->rgba(I);
+      if(cmd.using_video_camera() && d){
+        vpDisplay::display(I);
+        vpDisplay::flush(I);
+      }
+      t.process_event(tracking::input_ready(I,Y,cam,iter,timestamp));
+      if(cmd.logging_video()){
+        if(d)
+          d->getImage(logI);
+        else
+          logI = I;
+        writer.saveFrame(logI);
+      }
+      continue;
+    }
     if(cmd.using_video_camera()){
       video_reader.acquire(I);
-      vpDisplay::display(I);
-      vpDisplay::flush(I);
+      if(d){
+        vpDisplay::display(I);
+        vpDisplay::flush(I);
+      }
+    }
+    else if(source){
+      if(!source->acquire(I))
+        break;
+      timestamp = source->get_timestamp();
     }
     else if(!cmd.using_single_image())
       reader.acquire(I);
-    t.process_event(tracking::input_ready(I,cam,iter));
-    d->getImage(logI);
-    if(cmd.logging_video())
+    t.process_event(tracking::input_ready(I,cam,iter,timestamp));
+    if(cmd.logging_video()){
+      if(d)
+        d->getImage(logI);
+      else
+        logI = I;
       writer.saveFrame(logI);
+    }
   }
 
+  watcher.stop();
   t.process_event(tracking::finished());
+  display.stop();
+  if(cmd.using_model_registry() && cmd.get_verbose())
+    std::cout << "model registry: " << registry.get_loads() << " models loaded, " << registry.get_hits() << " reused" << std::endl;
+  if(shm_source && cmd.get_verbose())
+    std::cout << "shared memory ring: " << shm_source->get_acquired() << " frames tracked, " << shm_source->get_dropped() << " dropped" << std::endl;
   writer.close();
+  delete source;
+  delete d;
 }
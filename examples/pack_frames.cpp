@@ -0,0 +1,50 @@
+//command line parameters
+#include "cmd_line/cmd_line.h"
+
+//sources
+#include "sources/raw/writer.h"
+
+#include <iostream>
+
+//visp includes
+#include <visp/vpVideoReader.h>
+
+/*
+ * Converts the image sequence given by --data-directory and --video-input-path
+ * into the raw frame container given by --raw-container.
+ * Frames are timestamped at --frame-rate.
+ */
+int main(int argc, char**argv)
+{
+  //Parse command line arguments
+  CmdLine cmd(argc,argv);
+
+  if(cmd.should_exit()) return 0; //exit if needed
+  if(!cmd.using_raw_container()){
+    std::cout << "error: --raw-container is required" << std::endl;
+    return 1;
+  }
+
+  vpImage<vpRGBa> I;
+  vpVideoReader reader;
+  std::string filenames((cmd.get_data_dir() + cmd.get_input_file_pattern()));
+  if(cmd.get_verbose())
+    std::cout << "Loading: " << filenames << std::endl;
+  reader.setFileName( filenames.c_str() );
+
+  reader.setFirstFrameIndex(2); //same range as the tracking examples
+  reader.open(I);
+
+  sources::raw::Writer writer(cmd.get_raw_container_path(),
+                              cmd.raw_container_gray() ? sources::raw::FORMAT_GRAY : sources::raw::FORMAT_RGBA);
+  double period = 1000./cmd.get_frame_rate();
+  for(long i=reader.getFirstFrameIndex();i<=reader.getLastFrameIndex();i++){
+    reader.acquire(I);
+    writer.write(I,(i-reader.getFirstFrameIndex())*period);
+  }
+  writer.close();
+
+  if(cmd.get_verbose())
+    std::cout << "Wrote " << writer.get_frame_count() << " frames to " << cmd.get_raw_container_path() << std::endl;
+  return 0;
+}
@@ -0,0 +1,66 @@
+//command line parameters
+#include "cmd_line/cmd_line.h"
+
+//sources
+#include "sources/shm/writer.h"
+
+#include <iostream>
+
+//visp includes
+#include <visp/vpVideoReader.h>
+#include <visp/vpTime.h>
+
+/*
+ * Stand-in for an external capture process: publishes the image sequence given by --data-directory
+ * and --video-input-path into the shared memory ring --shm-ring at --frame-rate, then closes the ring.
+ * Start it before the tracker, e.g. ./tracking ... --shm-ring <same name>
+ */
+int main(int argc, char**argv)
+{
+  //Parse command line arguments
+  CmdLine cmd(argc,argv);
+
+  if(cmd.should_exit()) return 0; //exit if needed
+  if(!cmd.using_shm_ring()){
+    std::cout << "error: --shm-ring is required" << std::endl;
+    return 1;
+  }
+  sources::shm::pixel_format_t format;
+  if(cmd.get_shm_format() == "gray")
+    format = sources::shm::FORMAT_GRAY;
+  else if(cmd.get_shm_format() == "yuyv")
+    format = sources::shm::FORMAT_YUYV;
+  else if(cmd.get_shm_format() == "rgba")
+    format = sources::shm::FORMAT_RGBA;
+  else{
+    std::cout << "error: unknown --shm-format " << cmd.get_shm_format() << std::endl;
+    return 1;
+  }
+
+  vpImage<vpRGBa> I;
+  vpVideoReader reader;
+  std::string filenames((cmd.get_data_dir() + cmd.get_input_file_pattern()));
+  if(cmd.get_verbose())
+    std::cout << "Loading: " << filenames << std::endl;
+  reader.setFileName( filenames.c_str() );
+
+  reader.setFirstFrameIndex(2); //same range as the tracking examples
+  reader.open(I);
+
+  sources::shm::Writer writer(cmd.get_shm_ring(),I.getWidth(),I.getHeight(),format,cmd.get_shm_slots());
+  if(cmd.get_verbose())
+    std::cout << "Publishing to shared memory ring " << cmd.get_shm_ring() << std::endl;
+  double period = 1000./cmd.get_frame_rate();
+  double start = vpTime::measureTimeMs();
+  for(long i=reader.getFirstFrameIndex();i<=reader.getLastFrameIndex();i++){
+    reader.acquire(I);
+    //paced like a camera, whether a reader keeps up or not
+    vpTime::wait(start,(i-reader.getFirstFrameIndex())*period);
+    writer.write(I,vpTime::measureTimeMs());
+  }
+  writer.close();
+
+  if(cmd.get_verbose())
+    std::cout << "Published " << writer.get_frame_count() << " frames" << std::endl;
+  return 0;
+}
@@ -9,6 +9,10 @@
 #include "libauto_tracker/tracking.h"
 #include "libauto_tracker/threading.h"
 #include "libauto_tracker/events.h"
+#include "libauto_tracker/parallel_hybrid.h"
+
+//sources
+#include "sources/prefetch/source.h"
 
 //visp includes
 #include <visp/vpImageIo.h>
@@ -37,10 +41,16 @@ int main(int argc, char**argv)
   std::string filenames((cmd.get_data_dir() + cmd.get_input_file_pattern()));
   if(cmd.get_verbose())
     std::cout << "Loading: " << filenames << std::endl;
-  reader.setFileName( filenames.c_str() );
+  sources::prefetch::Source* prefetch = NULL;
+  if(cmd.using_prefetch()){
+    prefetch = new sources::prefetch::Source(filenames,2,cmd.get_prefetch_depth(),cmd.get_prefetch_workers(),cmd.get_frame_rate());
+    prefetch->open(I);
+  }else{
+    reader.setFileName( filenames.c_str() );
 
-  reader.setFirstFrameIndex(2);
-  reader.open(I);
+    reader.setFirstFrameIndex(2);
+    reader.open(I);
+  }
 
   //init display
   vpDisplayX* d = new vpDisplayX();
@@ -49,7 +59,7 @@ int main(int argc, char**argv)
   detectors::DetectorBase* detector = NULL;
   if (cmd.get_detector_type() == CmdLine::ZBAR)
     detector = new detectors::qrcode::Detector;
-  else if(cmd.get_detector_type() == CmdLine::DTMX)
+  else if(cmd.get_detector_type() == CmdLine::DMTX)
     detector = new detectors::datamatrix::Detector;
 
   if(cmd.get_tracker_type() == CmdLine::KLT)
@@ -58,17 +68,26 @@ int main(int argc, char**argv)
     tracker = new vpMbEdgeKltTracker();
   else if(cmd.get_tracker_type() == CmdLine::MBT)
     tracker = new vpMbEdgeTracker();
+  else if(cmd.get_tracker_type() == CmdLine::KLT_MBT_PARALLEL)
+    tracker = new tracking::ParallelHybridTracker();
 
   tracking::Tracker t(cmd,detector,tracker);
 
   t.start();
-  reader.acquire(I);
+  if(!prefetch)
+    reader.acquire(I);
 
   t.process_event(tracking::select_input(I));
-  for(int iter=0;(iter<reader.getLastFrameIndex()-1); iter++){
-    reader.acquire(I);
-    t.process_event(tracking::input_ready(I,cam,iter));
+  if(prefetch){
+    for(int iter=0;prefetch->acquire(I); iter++)
+      t.process_event(tracking::input_ready(I,cam,iter,prefetch->get_timestamp()));
+  }else{
+    for(int iter=0;(iter<reader.getLastFrameIndex()-1); iter++){
+      reader.acquire(I);
+      t.process_event(tracking::input_ready(I,cam,iter));
+    }
   }
 
   t.process_event(tracking::finished());
+  delete prefetch;
 }
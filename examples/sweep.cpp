@@ -0,0 +1,323 @@
+//command line parameters
+#include "cmd_line/cmd_line.h"
+
+//detectors
+#include "detectors/datamatrix/detector.h"
+#include "detectors/qrcode/detector.h"
+
+//tracking
+#include "libauto_tracker/tracking.h"
+#include "libauto_tracker/events.h"
+#include "libauto_tracker/parallel_hybrid.h"
+
+//sources
+#include "sources/raw/source.h"
+#include "sources/prefetch/source.h"
+
+//visp includes
+#include <visp/vpVideoReader.h>
+#include <visp/vpMbEdgeKltTracker.h>
+#include <visp/vpMbKltTracker.h>
+#include <visp/vpMbEdgeTracker.h>
+#include <visp/vpTime.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <boost/algorithm/string.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+
+/*
+ * Runs the tracker over one sequence for every point of a parameter grid.
+ * The sequence is decoded once (or mapped once when --raw-container is given) and shared read-only
+ * by all tracker instances, which run concurrently. Results are written to --sweep-output as one row per grid point.
+ *
+ * ./tracking_sweep -c config.cfg -D data/ -S 5 -r zbar --sweep R=1:20:1 --sweep Y=80,100,120
+ */
+
+//one axis of the grid: an option and the token lists it takes
+struct axis_t{
+  std::string option;
+  std::vector<std::vector<std::string> > values;
+};
+
+typedef struct {
+  double median,mean,max;
+} summary_t;
+
+struct result_t{
+  int frames;
+  int tracked;
+  double seconds;
+  summary_t var[8];
+  result_t() : frames(0),tracked(0),seconds(0.){
+    for(unsigned int i=0;i<8;i++)
+      var[i].median = var[i].mean = var[i].max = 0.;
+  }
+};
+
+static axis_t parse_axis(const std::string& spec){
+  axis_t axis;
+  std::string::size_type eq = spec.find('=');
+  if(eq == std::string::npos)
+    throw std::runtime_error("bad sweep axis (expected option=values): " + spec);
+  std::string name = spec.substr(0,eq);
+  axis.option = name.size()==1 ? "-" + name : "--" + name;
+  std::string values = spec.substr(eq+1);
+
+  std::vector<std::string> range;
+  boost::split(range,values,boost::is_any_of(":"));
+  if(range.size()==3){
+    double start = atof(range[0].c_str()), stop = atof(range[1].c_str()), step = atof(range[2].c_str());
+    if(step <= 0.)
+      throw std::runtime_error("bad sweep step: " + spec);
+    for(double v=start;v<=stop+step*1e-9;v+=step){
+      std::ostringstream token;
+      token << v;
+      axis.values.push_back(std::vector<std::string>(1,token.str()));
+    }
+  }else{
+    std::vector<std::string> list;
+    boost::split(list,values,boost::is_any_of(","));
+    for(std::vector<std::string>::iterator i = list.begin();i!=list.end();i++){
+      std::vector<std::string> tokens;
+      boost::split(tokens,*i,boost::is_any_of("/"));
+      axis.values.push_back(tokens);
+    }
+  }
+  return axis;
+}
+
+template<class Acc>
+static summary_t summarize(Acc& acc){
+  summary_t s;
+  s.median = boost::accumulators::median(acc);
+  s.mean = boost::accumulators::mean(acc);
+  s.max = boost::accumulators::max(acc);
+  return s;
+}
+
+//frames shared by all workers
+class Sequence{
+private:
+  std::vector<vpImage<vpRGBa> > frames_;
+  sources::raw::Source* raw_;
+  double period_;
+public:
+  Sequence(CmdLine& cmd) : raw_(NULL), period_(1000./cmd.get_frame_rate()){
+    if(cmd.using_raw_container()){
+      raw_ = new sources::raw::Source(cmd.get_raw_container_path());
+      return;
+    }
+    vpImage<vpRGBa> I;
+    std::string filenames(cmd.get_data_dir() + cmd.get_input_file_pattern());
+    if(cmd.using_prefetch()){
+      sources::prefetch::Source prefetch(filenames,2,cmd.get_prefetch_depth(),cmd.get_prefetch_workers(),cmd.get_frame_rate());
+      while(prefetch.acquire(I))
+        frames_.push_back(I);
+      return;
+    }
+    vpVideoReader reader;
+    reader.setFileName(filenames.c_str());
+    reader.setFirstFrameIndex(2);
+    reader.open(I);
+    for(long i=reader.getFirstFrameIndex();i<=reader.getLastFrameIndex();i++){
+      reader.acquire(I);
+      frames_.push_back(I);
+    }
+  }
+  ~Sequence(){
+    delete raw_;
+  }
+  int size() const{
+    return raw_ ? (int)raw_->get_frame_count() : (int)frames_.size();
+  }
+  //gray containers are tracked on their luminance, see get_gray
+  bool is_gray() const{
+    return raw_ && raw_->get_format() == sources::raw::FORMAT_GRAY;
+  }
+  unsigned int width() const{
+    return raw_ ? raw_->get_width() : (frames_.empty() ? 0 : frames_[0].getWidth());
+  }
+  unsigned int height() const{
+    return raw_ ? raw_->get_height() : (frames_.empty() ? 0 : frames_[0].getHeight());
+  }
+  //returns frame i, either decoded or as a view on the mapped container.
+  //It is shared with other workers and must not be modified
+  vpImage<vpRGBa>& get(int i, vpImage<vpRGBa>& view){
+    if(!raw_)
+      return frames_[i];
+    raw_->view(i,view);
+    return view;
+  }
+  //returns frame i of a gray container as a view on the mapping. Same sharing rules as get
+  vpImage<unsigned char>& get_gray(int i, vpImage<unsigned char>& view){
+    raw_->view(i,view);
+    return view;
+  }
+  double timestamp(int i) const{
+    return raw_ ? raw_->get_timestamp(i) : i*period_;
+  }
+};
+
+class SweepWorker{
+private:
+  int argc_;
+  char** argv_;
+  Sequence& sequence_;
+  vpCameraParameters cam_;
+  std::vector<std::vector<std::string> >& jobs_;
+  std::vector<result_t>& results_;
+  boost::atomic<unsigned int>& next_;
+public:
+  SweepWorker(int argc, char** argv, Sequence& sequence, const vpCameraParameters& cam,
+              std::vector<std::vector<std::string> >& jobs, std::vector<result_t>& results, boost::atomic<unsigned int>& next) :
+      argc_(argc),argv_(argv),sequence_(sequence),cam_(cam),jobs_(jobs),results_(results),next_(next){
+  }
+
+  void run(unsigned int job){
+    std::vector<std::string> overrides = jobs_[job];
+    overrides.push_back("--verbose");
+    overrides.push_back("0");
+    overrides.push_back("--show-plot");
+    overrides.push_back("0");
+    CmdLine cmd(argc_,argv_,overrides);
+
+    //released when the job throws too, the parallel tracker would leave its thread running
+    boost::scoped_ptr<detectors::DetectorBase> detector;
+    if (cmd.get_detector_type() == CmdLine::ZBAR)
+      detector.reset(new detectors::qrcode::Detector);
+    else
+      detector.reset(new detectors::datamatrix::Detector);
+
+    boost::scoped_ptr<vpMbTracker> tracker;
+    if(cmd.get_tracker_type() == CmdLine::KLT)
+      tracker.reset(new vpMbKltTracker());
+    else if(cmd.get_tracker_type() == CmdLine::KLT_MBT)
+      tracker.reset(new vpMbEdgeKltTracker());
+    else if(cmd.get_tracker_type() == CmdLine::KLT_MBT_PARALLEL)
+      tracker.reset(new tracking::ParallelHybridTracker());
+    else
+      tracker.reset(new vpMbEdgeTracker());
+
+    result_t& result = results_[job];
+    result.tracked = 0;
+    result.frames = sequence_.size();
+    double start = vpTime::measureTimeMs();
+    {
+      tracking::Tracker t(cmd,detector.get(),tracker.get(),false);
+      tracking::PoseSubscriber* poses = t.get_pose_publisher().subscribe(16);
+      tracking::pose_record_t record;
+      vpImage<vpRGBa> view;
+      vpImage<unsigned char> gray_view;
+      //gray frames come with their luminance, RGBA is only read for display and stays blank
+      vpImage<vpRGBa> blank;
+      bool gray = sequence_.is_gray();
+      if(gray)
+        blank.resize(sequence_.height(),sequence_.width());
+      t.start();
+      for(int i=0;i<sequence_.size();i++){
+        vpImage<vpRGBa>& I = gray ? blank : sequence_.get(i,view);
+        if(i==0)
+          t.process_event(tracking::select_input(I));
+        if(gray)
+          t.process_event(tracking::input_ready(I,sequence_.get_gray(i,gray_view),cam_,i,sequence_.timestamp(i)));
+        else
+          t.process_event(tracking::input_ready(I,cam_,i,sequence_.timestamp(i)));
+        while(poses->pop(record))
+          if(record.valid && record.state == tracking::STATE_TRACK_MODEL)
+            result.tracked++;
+      }
+      t.process_event(tracking::finished());
+
+      tracking::Tracker::statistics_t& statistics = t.get_statistics();
+      result.var[0] = summarize(statistics.var);
+      result.var[1] = summarize(statistics.var_x);
+      result.var[2] = summarize(statistics.var_y);
+      result.var[3] = summarize(statistics.var_z);
+      result.var[4] = summarize(statistics.var_wx);
+      result.var[5] = summarize(statistics.var_wy);
+      result.var[6] = summarize(statistics.var_wz);
+      result.var[7] = summarize(statistics.convergence_steps);
+    }
+    result.seconds = (vpTime::measureTimeMs() - start)/1000.;
+  }
+
+  void operator()(){
+    for(unsigned int job = next_++;job<jobs_.size();job = next_++){
+      try{
+        run(job);
+      }catch(std::exception& e){
+        std::cout << "sweep job " << job << " failed: " << e.what() << std::endl;
+      }
+    }
+  }
+};
+
+int main(int argc, char**argv)
+{
+  //Parse command line arguments
+  CmdLine cmd(argc,argv);
+
+  if(cmd.should_exit()) return 0; //exit if needed
+
+  //build the grid as the cartesian product of all axes
+  std::vector<axis_t> axes;
+  for(std::vector<std::string>::const_iterator i = cmd.get_sweep_params().begin();i!=cmd.get_sweep_params().end();i++)
+    axes.push_back(parse_axis(*i));
+
+  std::vector<std::vector<std::string> > jobs(1);
+  std::vector<std::vector<std::string> > labels(1);
+  for(std::vector<axis_t>::iterator axis = axes.begin();axis!=axes.end();axis++){
+    std::vector<std::vector<std::string> > grown,grown_labels;
+    for(unsigned int j=0;j<jobs.size();j++)
+      for(unsigned int v=0;v<axis->values.size();v++){
+        std::vector<std::string> job = jobs[j];
+        job.push_back(axis->option);
+        job.insert(job.end(),axis->values[v].begin(),axis->values[v].end());
+        grown.push_back(job);
+        std::vector<std::string> label = labels[j];
+        label.push_back(boost::algorithm::join(axis->values[v],"/"));
+        grown_labels.push_back(label);
+      }
+    jobs.swap(grown);
+    labels.swap(grown_labels);
+  }
+
+  vpCameraParameters cam = cmd.get_cam_calib_params();
+  Sequence sequence(cmd);
+  if(cmd.get_verbose())
+    std::cout << "Sweeping " << jobs.size() << " parameter sets over " << sequence.size() << " frames" << std::endl;
+
+  std::vector<result_t> results(jobs.size());
+  boost::atomic<unsigned int> next(0);
+  unsigned int nb_threads = cmd.get_sweep_jobs()>0 ? cmd.get_sweep_jobs() : boost::thread::hardware_concurrency();
+  boost::thread_group threads;
+  for(unsigned int i=0;i<std::max(nb_threads,1u);i++)
+    threads.create_thread(SweepWorker(argc,argv,sequence,cam,jobs,results,next));
+  threads.join_all();
+
+  std::ofstream out(cmd.get_sweep_output().c_str());
+  const char* groups[] = {"var","x","y","z","wx","wy","wz","init_steps"};
+  out << "#";
+  for(std::vector<axis_t>::iterator axis = axes.begin();axis!=axes.end();axis++)
+    out << axis->option << "\t";
+  out << "frames\ttracked\tseconds";
+  for(unsigned int g=0;g<8;g++)
+    out << "\t" << groups[g] << "_median\t" << groups[g] << "_mean\t" << groups[g] << "_max";
+  out << std::endl;
+  for(unsigned int j=0;j<jobs.size();j++){
+    for(unsigned int a=0;a<labels[j].size();a++)
+      out << labels[j][a] << "\t";
+    out << results[j].frames << "\t" << results[j].tracked << "\t" << results[j].seconds;
+    for(unsigned int g=0;g<8;g++)
+      out << "\t" << results[j].var[g].median << "\t" << results[j].var[g].mean << "\t" << results[j].var[g].max;
+    out << std::endl;
+  }
+  if(cmd.get_verbose())
+    std::cout << "Results written to " << cmd.get_sweep_output() << std::endl;
+  return 0;
+}
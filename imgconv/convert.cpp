@@ -0,0 +1,148 @@
+#include "convert.h"
+#include "kernels.h"
+
+namespace imgconv{
+  void scalar_rgba_to_gray(const unsigned char* rgba, unsigned char* gray, unsigned int n){
+    for(unsigned int i=0;i<n;i++,rgba+=4)
+      gray[i] = (unsigned char)((W_R*rgba[0] + W_G*rgba[1] + W_B*rgba[2])>>8);
+  }
+
+  void scalar_rgba_to_bgr(const unsigned char* rgba, unsigned char* bgr, unsigned int n){
+    for(unsigned int i=0;i<n;i++,rgba+=4,bgr+=3){
+      bgr[0] = rgba[2];
+      bgr[1] = rgba[1];
+      bgr[2] = rgba[0];
+    }
+  }
+
+  void scalar_bgr_to_gray(const unsigned char* bgr, unsigned char* gray, unsigned int n){
+    for(unsigned int i=0;i<n;i++,bgr+=3)
+      gray[i] = (unsigned char)((W_R*bgr[2] + W_G*bgr[1] + W_B*bgr[0])>>8);
+  }
+
+  void scalar_yuyv_to_gray(const unsigned char* yuyv, unsigned char* gray, unsigned int n){
+    for(unsigned int i=0;i<n;i++)
+      gray[i] = yuyv[2*i];
+  }
+
+  static const kernels_t scalar_kernels = {
+    "scalar",
+    scalar_rgba_to_gray,
+    scalar_rgba_to_bgr,
+    scalar_bgr_to_gray,
+    scalar_yuyv_to_gray
+  };
+
+  const kernels_t* get_scalar_kernels(){
+    return &scalar_kernels;
+  }
+
+  //kernels built in and usable on this cpu, NULL otherwise
+  static const kernels_t* find_kernels(isa_t isa){
+    switch(isa){
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+      case ISA_AVX2:
+        return __builtin_cpu_supports("avx2") ? get_avx2_kernels() : NULL;
+      case ISA_SSE2:
+        return __builtin_cpu_supports("sse2") ? get_sse2_kernels() : NULL;
+#endif
+      case ISA_NEON:
+        //neon is part of the target when the file is built with it
+        return get_neon_kernels();
+      case ISA_SCALAR:
+        return get_scalar_kernels();
+      default:
+        return NULL;
+    }
+  }
+
+  struct dispatch_t{
+    isa_t isa;
+    const kernels_t* kernels;
+    dispatch_t() : isa(ISA_SCALAR), kernels(get_scalar_kernels()){
+      const isa_t preferred[] = {ISA_AVX2, ISA_NEON, ISA_SSE2};
+      for(unsigned int i=0;i<sizeof(preferred)/sizeof(preferred[0]);i++){
+        const kernels_t* found = find_kernels(preferred[i]);
+        if(found){
+          isa = preferred[i];
+          kernels = found;
+          break;
+        }
+      }
+    }
+  };
+
+  //resolved on first use, the kernels are then a plain indirect call
+  static dispatch_t& get_dispatch(){
+    static dispatch_t dispatch;
+    return dispatch;
+  }
+
+  isa_t get_isa(){
+    return get_dispatch().isa;
+  }
+
+  const char* get_isa_name(){
+    return get_dispatch().kernels->name;
+  }
+
+  bool set_isa(isa_t isa){
+    const kernels_t* found = find_kernels(isa);
+    if(!found)
+      return false;
+    get_dispatch().isa = isa;
+    get_dispatch().kernels = found;
+    return true;
+  }
+
+  void rgba_to_gray(const unsigned char* rgba, unsigned char* gray, unsigned int n){
+    get_dispatch().kernels->rgba_to_gray(rgba,gray,n);
+  }
+
+  void rgba_to_bgr(const unsigned char* rgba, unsigned char* bgr, unsigned int n){
+    get_dispatch().kernels->rgba_to_bgr(rgba,bgr,n);
+  }
+
+  void bgr_to_gray(const unsigned char* bgr, unsigned char* gray, unsigned int n){
+    get_dispatch().kernels->bgr_to_gray(bgr,gray,n);
+  }
+
+  void yuyv_to_gray(const unsigned char* yuyv, unsigned char* gray, unsigned int n){
+    get_dispatch().kernels->yuyv_to_gray(yuyv,gray,n);
+  }
+
+  void convert(const vpImage<vpRGBa>& I, vpImage<unsigned char>& gray){
+    if(gray.getHeight()!=I.getHeight() || gray.getWidth()!=I.getWidth())
+      gray.resize(I.getHeight(),I.getWidth());
+    //vpImage rows are contiguous, the whole image is one row
+    rgba_to_gray((const unsigned char*)I.bitmap,gray.bitmap,I.getHeight()*I.getWidth());
+  }
+
+  void convert(const vpImage<vpRGBa>& I, cv::Mat& bgr){
+    //create() only reallocates when the size changes
+    bgr.create((int)I.getHeight(),(int)I.getWidth(),CV_8UC3);
+    if(bgr.isContinuous()){
+      rgba_to_bgr((const unsigned char*)I.bitmap,bgr.data,I.getHeight()*I.getWidth());
+      return;
+    }
+    for(unsigned int v=0;v<I.getHeight();v++)
+      rgba_to_bgr((const unsigned char*)I[v],bgr.ptr<unsigned char>(v),I.getWidth());
+  }
+
+  void convert(const cv::Mat& bgr, cv::Mat& gray){
+    CV_Assert(bgr.type()==CV_8UC3);
+    gray.create(bgr.rows,bgr.cols,CV_8UC1);
+    if(bgr.isContinuous() && gray.isContinuous()){
+      bgr_to_gray(bgr.data,gray.data,(unsigned int)(bgr.rows*bgr.cols));
+      return;
+    }
+    for(int v=0;v<bgr.rows;v++)
+      bgr_to_gray(bgr.ptr<unsigned char>(v),gray.ptr<unsigned char>(v),(unsigned int)bgr.cols);
+  }
+
+  void yuyv_to_gray(const unsigned char* yuyv, unsigned int width, unsigned int height, vpImage<unsigned char>& gray){
+    if(gray.getWidth()!=width || gray.getHeight()!=height)
+      gray.resize(height,width);
+    yuyv_to_gray(yuyv,gray.bitmap,width*height);
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef __IMGCONV_CONVERT_H__
+#define __IMGCONV_CONVERT_H__
+#include "cv.h"
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+/*
+ * Colour conversions of the frame path (RGBA to gray and BGR, BGR to gray, YUYV to gray) with vector kernels
+ * picked once at runtime from what the cpu supports: avx2 or sse2 on x86, neon on arm, plain C++ otherwise.
+ * Gray is the fixed point (54*R + 183*G + 19*B) >> 8 whatever the kernels, so the output does not depend on the
+ * machine. It stays within one level of vpImageConvert.
+ */
+namespace imgconv{
+  enum isa_t{
+    ISA_SCALAR,
+    ISA_SSE2,
+    ISA_AVX2,
+    ISA_NEON
+  };
+
+  //instruction set of the kernels in use
+  isa_t get_isa();
+  const char* get_isa_name();
+  //forces the kernels, mostly to compare them. Returns false when isa is not built in or not supported by the cpu
+  bool set_isa(isa_t isa);
+
+  //one row of n pixels, buffers are packed and do not overlap
+  void rgba_to_gray(const unsigned char* rgba, unsigned char* gray, unsigned int n);
+  void rgba_to_bgr(const unsigned char* rgba, unsigned char* bgr, unsigned int n);
+  void bgr_to_gray(const unsigned char* bgr, unsigned char* gray, unsigned int n);
+  void yuyv_to_gray(const unsigned char* yuyv, unsigned char* gray, unsigned int n);
+
+  //whole images, the destination is resized when needed
+  void convert(const vpImage<vpRGBa>& I, vpImage<unsigned char>& gray);
+  //bgr becomes CV_8UC3
+  void convert(const vpImage<vpRGBa>& I, cv::Mat& bgr);
+  //bgr is CV_8UC3, gray becomes CV_8UC1
+  void convert(const cv::Mat& bgr, cv::Mat& gray);
+  void yuyv_to_gray(const unsigned char* yuyv, unsigned int width, unsigned int height, vpImage<unsigned char>& gray);
+}
+#endif /* __IMGCONV_CONVERT_H__ */
@@ -0,0 +1,33 @@
+#ifndef __IMGCONV_KERNELS_H__
+#define __IMGCONV_KERNELS_H__
+#include <cstddef>
+
+namespace imgconv{
+  //gray = (R*W_R + G*W_G + B*W_B) >> 8 in every kernel set, so that results do not depend on the cpu.
+  //8 bit weights keep the sums in 16 bits, and stay within one level of the floating point vpImageConvert
+  static const unsigned int W_R = 54, W_G = 183, W_B = 19;
+
+  //one row of n pixels
+  typedef void (*row_kernel_t)(const unsigned char* src, unsigned char* dst, unsigned int n);
+
+  //one conversion set per instruction set, those without a vector version point to the scalar one
+  struct kernels_t{
+    const char* name;
+    row_kernel_t rgba_to_gray;
+    row_kernel_t rgba_to_bgr;
+    row_kernel_t bgr_to_gray;
+    row_kernel_t yuyv_to_gray;
+  };
+
+  void scalar_rgba_to_gray(const unsigned char* rgba, unsigned char* gray, unsigned int n);
+  void scalar_rgba_to_bgr(const unsigned char* rgba, unsigned char* bgr, unsigned int n);
+  void scalar_bgr_to_gray(const unsigned char* bgr, unsigned char* gray, unsigned int n);
+  void scalar_yuyv_to_gray(const unsigned char* yuyv, unsigned char* gray, unsigned int n);
+
+  //NULL when the file was built without the instruction set
+  const kernels_t* get_scalar_kernels();
+  const kernels_t* get_sse2_kernels();
+  const kernels_t* get_avx2_kernels();
+  const kernels_t* get_neon_kernels();
+}
+#endif /* __IMGCONV_KERNELS_H__ */
@@ -0,0 +1,107 @@
+#include "kernels.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace imgconv{
+#ifdef __AVX2__
+  //8 rgba pixels to 8 gray values in the low byte of 32 bit lanes
+  static inline __m256i gray8(__m256i rgba, __m256i mask, __m256i w_rb, __m256i w_g){
+    __m256i rb = _mm256_and_si256(rgba,mask);
+    __m256i ga = _mm256_and_si256(_mm256_srli_epi32(rgba,8),mask);
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(rb,w_rb),_mm256_madd_epi16(ga,w_g));
+    return _mm256_srli_epi32(sum,8);
+  }
+
+  //packs 4x8 gray values in 32 bit lanes to 32 bytes. Packs work within 128 bit halves, the permutation restores pixel order
+  static inline __m256i pack32(__m256i g0, __m256i g1, __m256i g2, __m256i g3){
+    __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(g0,g1),_mm256_packs_epi32(g2,g3));
+    return _mm256_permutevar8x32_epi32(packed,_mm256_setr_epi32(0,4,1,5,2,6,3,7));
+  }
+
+  static void avx2_rgba_to_gray(const unsigned char* rgba, unsigned char* gray, unsigned int n){
+    const __m256i mask = _mm256_set1_epi32(0x00FF00FF),
+                  w_rb = _mm256_set1_epi32((int)(W_B<<16 | W_R)),
+                  w_g = _mm256_set1_epi32((int)W_G);
+    unsigned int i = 0;
+    for(;i+32<=n;i+=32){
+      const __m256i* src = (const __m256i*)(rgba+4*i);
+      __m256i g0 = gray8(_mm256_loadu_si256(src),mask,w_rb,w_g),
+              g1 = gray8(_mm256_loadu_si256(src+1),mask,w_rb,w_g),
+              g2 = gray8(_mm256_loadu_si256(src+2),mask,w_rb,w_g),
+              g3 = gray8(_mm256_loadu_si256(src+3),mask,w_rb,w_g);
+      _mm256_storeu_si256((__m256i*)(gray+i),pack32(g0,g1,g2,g3));
+    }
+    scalar_rgba_to_gray(rgba+4*i,gray+i,n-i);
+  }
+
+  static void avx2_rgba_to_bgr(const unsigned char* rgba, unsigned char* bgr, unsigned int n){
+    //per 128 bit half, 4 rgba pixels to 12 bgr bytes followed by 4 bytes overwritten by the next store
+    const __m256i shuffle = _mm256_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1,
+                                             2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1);
+    unsigned int i = 0;
+    //the last 16 byte store of an iteration ends 4 bytes past its pixels, stay 2 pixels away from the end
+    for(;i+10<=n;i+=8){
+      __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(rgba+4*i)),shuffle);
+      _mm_storeu_si128((__m128i*)(bgr+3*i),_mm256_castsi256_si128(v));
+      _mm_storeu_si128((__m128i*)(bgr+3*i+12),_mm256_extracti128_si256(v,1));
+    }
+    scalar_rgba_to_bgr(rgba+4*i,bgr+3*i,n-i);
+  }
+
+  static void avx2_bgr_to_gray(const unsigned char* bgr, unsigned char* gray, unsigned int n){
+    //per 128 bit half, 4 bgr pixels spread to (R,B) and (G,0) 16 bit pairs of 32 bit lanes
+    const __m256i to_rb = _mm256_setr_epi8(2,-1,0,-1, 5,-1,3,-1, 8,-1,6,-1, 11,-1,9,-1,
+                                           2,-1,0,-1, 5,-1,3,-1, 8,-1,6,-1, 11,-1,9,-1),
+                  to_g = _mm256_setr_epi8(1,-1,-1,-1, 4,-1,-1,-1, 7,-1,-1,-1, 10,-1,-1,-1,
+                                          1,-1,-1,-1, 4,-1,-1,-1, 7,-1,-1,-1, 10,-1,-1,-1),
+                  w_rb = _mm256_set1_epi32((int)(W_B<<16 | W_R)),
+                  w_g = _mm256_set1_epi32((int)W_G);
+    __m256i g[4];
+    unsigned int i = 0;
+    //16 byte loads read 4 bytes past their 4 pixels, stay 2 pixels away from the end
+    for(;i+34<=n;i+=32){
+      for(unsigned int k=0;k<4;k++){
+        const unsigned char* src = bgr+3*(i+8*k);
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src)),
+                                            _mm_loadu_si128((const __m128i*)(src+12)),1);
+        __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(v,to_rb),w_rb),
+                                       _mm256_madd_epi16(_mm256_shuffle_epi8(v,to_g),w_g));
+        g[k] = _mm256_srli_epi32(sum,8);
+      }
+      _mm256_storeu_si256((__m256i*)(gray+i),pack32(g[0],g[1],g[2],g[3]));
+    }
+    scalar_bgr_to_gray(bgr+3*i,gray+i,n-i);
+  }
+
+  static void avx2_yuyv_to_gray(const unsigned char* yuyv, unsigned char* gray, unsigned int n){
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    unsigned int i = 0;
+    for(;i+32<=n;i+=32){
+      const __m256i* src = (const __m256i*)(yuyv+2*i);
+      __m256i y0 = _mm256_and_si256(_mm256_loadu_si256(src),mask),
+              y1 = _mm256_and_si256(_mm256_loadu_si256(src+1),mask);
+      //the pack interleaves the 128 bit halves of y0 and y1
+      __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(y0,y1),0xD8);
+      _mm256_storeu_si256((__m256i*)(gray+i),packed);
+    }
+    scalar_yuyv_to_gray(yuyv+2*i,gray+i,n-i);
+  }
+
+  static const kernels_t avx2_kernels = {
+    "avx2",
+    avx2_rgba_to_gray,
+    avx2_rgba_to_bgr,
+    avx2_bgr_to_gray,
+    avx2_yuyv_to_gray
+  };
+
+  const kernels_t* get_avx2_kernels(){
+    return &avx2_kernels;
+  }
+#else
+  const kernels_t* get_avx2_kernels(){
+    return NULL;
+  }
+#endif
+}
@@ -0,0 +1,75 @@
+#include "kernels.h"
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMGCONV_NEON
+#endif
+
+namespace imgconv{
+#ifdef IMGCONV_NEON
+  //16 pixels from their deinterleaved channels
+  static inline uint8x16_t gray16(uint8x16_t r, uint8x16_t g, uint8x16_t b){
+    const uint8x8_t w_r = vdup_n_u8(W_R), w_g = vdup_n_u8(W_G), w_b = vdup_n_u8(W_B);
+    uint16x8_t lo = vmull_u8(vget_low_u8(r),w_r);
+    lo = vmlal_u8(lo,vget_low_u8(g),w_g);
+    lo = vmlal_u8(lo,vget_low_u8(b),w_b);
+    uint16x8_t hi = vmull_u8(vget_high_u8(r),w_r);
+    hi = vmlal_u8(hi,vget_high_u8(g),w_g);
+    hi = vmlal_u8(hi,vget_high_u8(b),w_b);
+    return vcombine_u8(vshrn_n_u16(lo,8),vshrn_n_u16(hi,8));
+  }
+
+  static void neon_rgba_to_gray(const unsigned char* rgba, unsigned char* gray, unsigned int n){
+    unsigned int i = 0;
+    for(;i+16<=n;i+=16){
+      uint8x16x4_t v = vld4q_u8(rgba+4*i);
+      vst1q_u8(gray+i,gray16(v.val[0],v.val[1],v.val[2]));
+    }
+    scalar_rgba_to_gray(rgba+4*i,gray+i,n-i);
+  }
+
+  static void neon_rgba_to_bgr(const unsigned char* rgba, unsigned char* bgr, unsigned int n){
+    unsigned int i = 0;
+    for(;i+16<=n;i+=16){
+      uint8x16x4_t v = vld4q_u8(rgba+4*i);
+      uint8x16x3_t out;
+      out.val[0] = v.val[2];
+      out.val[1] = v.val[1];
+      out.val[2] = v.val[0];
+      vst3q_u8(bgr+3*i,out);
+    }
+    scalar_rgba_to_bgr(rgba+4*i,bgr+3*i,n-i);
+  }
+
+  static void neon_bgr_to_gray(const unsigned char* bgr, unsigned char* gray, unsigned int n){
+    unsigned int i = 0;
+    for(;i+16<=n;i+=16){
+      uint8x16x3_t v = vld3q_u8(bgr+3*i);
+      vst1q_u8(gray+i,gray16(v.val[2],v.val[1],v.val[0]));
+    }
+    scalar_bgr_to_gray(bgr+3*i,gray+i,n-i);
+  }
+
+  static void neon_yuyv_to_gray(const unsigned char* yuyv, unsigned char* gray, unsigned int n){
+    unsigned int i = 0;
+    for(;i+16<=n;i+=16)
+      vst1q_u8(gray+i,vld2q_u8(yuyv+2*i).val[0]);
+    scalar_yuyv_to_gray(yuyv+2*i,gray+i,n-i);
+  }
+
+  static const kernels_t neon_kernels = {
+    "neon",
+    neon_rgba_to_gray,
+    neon_rgba_to_bgr,
+    neon_bgr_to_gray,
+    neon_yuyv_to_gray
+  };
+
+  const kernels_t* get_neon_kernels(){
+    return &neon_kernels;
+  }
+#else
+  const kernels_t* get_neon_kernels(){
+    return NULL;
+  }
+#endif
+}
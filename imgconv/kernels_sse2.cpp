@@ -0,0 +1,62 @@
+#include "kernels.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace imgconv{
+#ifdef __SSE2__
+  //4 rgba pixels to 4 gray values in the low byte of 32 bit lanes
+  static inline __m128i gray4(__m128i rgba, __m128i mask, __m128i w_rb, __m128i w_g){
+    __m128i rb = _mm_and_si128(rgba,mask);                    //R and B as 16 bit pairs
+    __m128i ga = _mm_and_si128(_mm_srli_epi32(rgba,8),mask);  //G and A
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(rb,w_rb),_mm_madd_epi16(ga,w_g));
+    return _mm_srli_epi32(sum,8);
+  }
+
+  static void sse2_rgba_to_gray(const unsigned char* rgba, unsigned char* gray, unsigned int n){
+    const __m128i mask = _mm_set1_epi32(0x00FF00FF),
+                  w_rb = _mm_set1_epi32((int)(W_B<<16 | W_R)),
+                  w_g = _mm_set1_epi32((int)W_G);
+    unsigned int i = 0;
+    for(;i+16<=n;i+=16){
+      const __m128i* src = (const __m128i*)(rgba+4*i);
+      __m128i g0 = gray4(_mm_loadu_si128(src),mask,w_rb,w_g),
+              g1 = gray4(_mm_loadu_si128(src+1),mask,w_rb,w_g),
+              g2 = gray4(_mm_loadu_si128(src+2),mask,w_rb,w_g),
+              g3 = gray4(_mm_loadu_si128(src+3),mask,w_rb,w_g);
+      __m128i packed = _mm_packus_epi16(_mm_packs_epi32(g0,g1),_mm_packs_epi32(g2,g3));
+      _mm_storeu_si128((__m128i*)(gray+i),packed);
+    }
+    scalar_rgba_to_gray(rgba+4*i,gray+i,n-i);
+  }
+
+  static void sse2_yuyv_to_gray(const unsigned char* yuyv, unsigned char* gray, unsigned int n){
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    unsigned int i = 0;
+    for(;i+16<=n;i+=16){
+      const __m128i* src = (const __m128i*)(yuyv+2*i);
+      __m128i y0 = _mm_and_si128(_mm_loadu_si128(src),mask),
+              y1 = _mm_and_si128(_mm_loadu_si128(src+1),mask);
+      _mm_storeu_si128((__m128i*)(gray+i),_mm_packus_epi16(y0,y1));
+    }
+    scalar_yuyv_to_gray(yuyv+2*i,gray+i,n-i);
+  }
+
+  //packing 3 byte pixels needs byte shuffles (ssse3 and up), bgr stays scalar at this level
+  static const kernels_t sse2_kernels = {
+    "sse2",
+    sse2_rgba_to_gray,
+    scalar_rgba_to_bgr,
+    scalar_bgr_to_gray,
+    sse2_yuyv_to_gray
+  };
+
+  const kernels_t* get_sse2_kernels(){
+    return &sse2_kernels;
+  }
+#else
+  const kernels_t* get_sse2_kernels(){
+    return NULL;
+  }
+#endif
+}
@@ -0,0 +1,130 @@
+#include "config_delta.h"
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+
+namespace tracking{
+  struct option_definition_t{
+    const char* name;
+    const char* letter;
+    unsigned int nb_values;
+    bool integer;
+    double min;       //values must be above min, or equal when min_included
+    bool min_included;
+    double max;
+  };
+
+  //indexed by ConfigDelta::option_t
+  static const option_definition_t definitions[ConfigDelta::NB_OPTIONS] = {
+    { "mbt-dynamic-range",          "R", 1, false, 0., false, 1e9 },
+    { "variance-limit",             "l", 1, false, 0., false, 1e9 },
+    { "hinkley-range",              "H", 2, false, 0., false, 1e9 },
+    { "ad-hoc-recovery-threshold",  "Y", 1, true,  0., true,  255. },
+    { "ad-hoc-recovery-size",       "w", 1, false, 0., false, 1e9 },
+    { "dmx-detector-timeout",       "T", 1, true,  0., true,  1e9 },
+    { "mbt-convergence-steps",      "S", 1, true,  1., true,  1e9 },
+    { "fast-recovery-steps",        "",  1, true,  0., true,  1e9 }
+  };
+
+  static std::string trim(const std::string& s){
+    std::string::size_type begin = s.find_first_not_of(" \t\r\n"),
+                           end = s.find_last_not_of(" \t\r\n");
+    if(begin==std::string::npos)
+      return std::string();
+    return s.substr(begin,end-begin+1);
+  }
+
+  ConfigDelta:: ConfigDelta(){
+    clear();
+  }
+
+  ConfigDelta::option_t ConfigDelta:: find(const std::string& name){
+    for(unsigned int i=0;i<NB_OPTIONS;i++)
+      if(name==definitions[i].name || (definitions[i].letter[0] && name==definitions[i].letter))
+        return (option_t)i;
+    return NB_OPTIONS;
+  }
+
+  const char* ConfigDelta:: get_name(option_t option){
+    return option<NB_OPTIONS ? definitions[option].name : "unknown";
+  }
+
+  bool ConfigDelta:: set(const std::string& name, const std::vector<std::string>& values, std::string& error){
+    option_t option = find(trim(name));
+    if(option==NB_OPTIONS){
+      error = "\"" + trim(name) + "\" cannot be changed while tracking";
+      return false;
+    }
+    const option_definition_t& definition = definitions[option];
+    std::ostringstream message;
+    if(values.size()!=definition.nb_values){
+      message << definition.name << " takes " << definition.nb_values << " value(s), " << values.size() << " given";
+      error = message.str();
+      return false;
+    }
+    std::vector<double> parsed;
+    for(unsigned int i=0;i<values.size();i++){
+      std::string token = trim(values[i]);
+      char* end = NULL;
+      double value = std::strtod(token.c_str(),&end);
+      bool valid = !token.empty() && *end=='\0'
+                   && (definition.integer ? value==std::floor(value) : true)
+                   && (definition.min_included ? value>=definition.min : value>definition.min)
+                   && value<=definition.max;
+      if(!valid){
+        message << definition.name << ": invalid value \"" << token << "\"";
+        error = message.str();
+        return false;
+      }
+      parsed.push_back(value);
+    }
+    has_[option] = true;
+    values_[option].swap(parsed);
+    return true;
+  }
+
+  bool ConfigDelta:: set(const std::string& assignment, std::string& error){
+    std::string::size_type equal = assignment.find('=');
+    if(equal==std::string::npos){
+      error = "expected name=value in \"" + assignment + "\"";
+      return false;
+    }
+    std::vector<std::string> values;
+    std::istringstream tokens(assignment.substr(equal+1));
+    std::string token;
+    while(std::getline(tokens,token,','))
+      values.push_back(token);
+    return set(assignment.substr(0,equal),values,error);
+  }
+
+  bool ConfigDelta:: empty() const{
+    for(unsigned int i=0;i<NB_OPTIONS;i++)
+      if(has_[i])
+        return false;
+    return true;
+  }
+
+  bool ConfigDelta:: has(option_t option) const{
+    return has_[option];
+  }
+
+  double ConfigDelta:: get(option_t option, unsigned int i) const{
+    return values_[option][i];
+  }
+
+  void ConfigDelta:: merge(const ConfigDelta& other){
+    for(unsigned int i=0;i<NB_OPTIONS;i++){
+      if(!other.has_[i])
+        continue;
+      has_[i] = true;
+      values_[i] = other.values_[i];
+    }
+  }
+
+  void ConfigDelta:: clear(){
+    for(unsigned int i=0;i<NB_OPTIONS;i++){
+      has_[i] = false;
+      values_[i].clear();
+    }
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef __CONFIG_DELTA_H__
+#define __CONFIG_DELTA_H__
+#include <string>
+#include <vector>
+#include <boost/array.hpp>
+
+namespace tracking{
+  /*
+   * Changes of tuning options for a running tracker, see Tracker_::reconfigure.
+   * Only options read while tracking are accepted: those that shape the model or the visp tracker need a restart.
+   * Values are validated when they are set so that a delta is either applied as a whole or refused.
+   */
+  class ConfigDelta{
+  public:
+    enum option_t{
+      MBT_DYNAMIC_RANGE,        //-R
+      VARIANCE_LIMIT,           //-l
+      HINKLEY_RANGE,            //-H, alpha and delta
+      ADHOC_RECOVERY_THRESHOLD, //-Y
+      ADHOC_RECOVERY_SIZE,      //-w
+      DMX_TIMEOUT,              //-T
+      MBT_CONVERGENCE_STEPS,    //-S
+      FAST_RECOVERY_STEPS,
+      NB_OPTIONS
+    };
+  private:
+    boost::array<bool,NB_OPTIONS> has_;
+    boost::array<std::vector<double>,NB_OPTIONS> values_;
+  public:
+    ConfigDelta();
+    //name is the long name of the option or its letter, one value per token as in the config file.
+    //Returns false with a message in error when the option cannot be changed while tracking or a value is invalid
+    bool set(const std::string& name, const std::vector<std::string>& values, std::string& error);
+    //same as above from "name=value" or "name=value,value"
+    bool set(const std::string& assignment, std::string& error);
+    bool empty() const;
+    bool has(option_t option) const;
+    double get(option_t option, unsigned int i = 0) const;
+    //takes the options set in other, replacing those set in both
+    void merge(const ConfigDelta& other);
+    void clear();
+
+    static const char* get_name(option_t option);
+    //option named name (long or letter), NB_OPTIONS when it cannot be changed while tracking
+    static option_t find(const std::string& name);
+  };
+}
+#endif /* __CONFIG_DELTA_H__ */
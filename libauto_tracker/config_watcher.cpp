@@ -0,0 +1,145 @@
+#include "config_watcher.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <sys/stat.h>
+
+namespace tracking{
+  static std::string trim(const std::string& s){
+    std::string::size_type begin = s.find_first_not_of(" \t\r\n"),
+                           end = s.find_last_not_of(" \t\r\n");
+    if(begin==std::string::npos)
+      return std::string();
+    return s.substr(begin,end-begin+1);
+  }
+
+  ConfigWatcher:: ConfigWatcher(Tracker_& tracker, const std::string& path, unsigned int period, bool verbose) :
+      tracker_(tracker),
+      path_(path),
+      period_(std::max(period,1u)),
+      verbose_(verbose),
+      mtime_(0),
+      size_(0),
+      stop_(false),
+      thread_(NULL),
+      applied_(0),
+      refused_(0){
+    struct stat status;
+    if(stat(path_.c_str(),&status)==0){
+      mtime_ = status.st_mtime;
+      size_ = status.st_size;
+    }
+    read(path_,values_);
+  }
+
+  ConfigWatcher:: ~ConfigWatcher(){
+    stop();
+  }
+
+  void ConfigWatcher:: start(){
+    if(thread_)
+      return;
+    stop_ = false;
+    thread_ = new boost::thread(&ConfigWatcher::run,this);
+  }
+
+  void ConfigWatcher:: stop(){
+    if(!thread_)
+      return;
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_one();
+    thread_->join();
+    delete thread_;
+    thread_ = NULL;
+  }
+
+  void ConfigWatcher:: run(){
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while(!stop_){
+      wake_.timed_wait(lock,boost::posix_time::milliseconds(period_));
+      if(stop_)
+        break;
+      lock.unlock();
+      poll();
+      lock.lock();
+    }
+  }
+
+  bool ConfigWatcher:: read(const std::string& path, values_t& values){
+    std::ifstream in(path.c_str());
+    if(!in)
+      return false;
+    values.clear();
+    std::string line;
+    while(std::getline(in,line)){
+      line = trim(line);
+      std::string::size_type equal = line.find('=');
+      if(line.empty() || line[0]=='#' || equal==std::string::npos)
+        continue;
+      values[trim(line.substr(0,equal))].push_back(trim(line.substr(equal+1)));
+    }
+    return true;
+  }
+
+  bool ConfigWatcher:: poll(){
+    struct stat status;
+    if(stat(path_.c_str(),&status)!=0 || (status.st_mtime==mtime_ && status.st_size==size_))
+      return false;
+    mtime_ = status.st_mtime;
+    size_ = status.st_size;
+    values_t values;
+    if(!read(path_,values))
+      return false;
+
+    //options changed, added or removed since the last read
+    std::vector<std::string> changed;
+    for(values_t::const_iterator i = values.begin();i!=values.end();i++){
+      values_t::const_iterator previous = values_.find(i->first);
+      if(previous==values_.end() || previous->second!=i->second)
+        changed.push_back(i->first);
+    }
+    for(values_t::const_iterator i = values_.begin();i!=values_.end();i++)
+      if(values.count(i->first)==0)
+        changed.push_back(i->first);
+    values_.swap(values);
+    if(changed.empty())
+      return false;
+
+    ConfigDelta delta;
+    std::string error;
+    bool valid = true;
+    for(std::vector<std::string>::const_iterator name = changed.begin();name!=changed.end();name++){
+      values_t::const_iterator value = values_.find(*name);
+      if(ConfigDelta::find(*name)==ConfigDelta::NB_OPTIONS || value==values_.end()){
+        std::cout << "config watcher: change of " << *name << " needs a restart, ignored" << std::endl;
+        continue;
+      }
+      if(!delta.set(*name,value->second,error)){
+        valid = false;
+        break;
+      }
+    }
+    if(delta.empty() && valid)
+      return false;
+    if(!valid || !tracker_.reconfigure(delta,error)){
+      std::cout << "config watcher: " << path_ << " refused, " << error << std::endl;
+      refused_.fetch_add(1,boost::memory_order_relaxed);
+      return false;
+    }
+    if(verbose_)
+      std::cout << "config watcher: " << path_ << " changed, applying on the next frame" << std::endl;
+    applied_.fetch_add(1,boost::memory_order_relaxed);
+    return true;
+  }
+
+  unsigned long ConfigWatcher:: get_applied() const{
+    return applied_.load(boost::memory_order_relaxed);
+  }
+
+  unsigned long ConfigWatcher:: get_refused() const{
+    return refused_.load(boost::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef __CONFIG_WATCHER_H__
+#define __CONFIG_WATCHER_H__
+#include <string>
+#include <vector>
+#include <map>
+#include <ctime>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include "tracking.h"
+#include "config_delta.h"
+
+namespace tracking{
+  /*
+   * Watches a config file and hands the tuning options changed in it to a running tracker as one delta.
+   * The file is polled: it is read again when its modification time or size change.
+   * Changes of options that cannot be tuned while tracking are reported and ignored.
+   */
+  class ConfigWatcher{
+  private:
+    typedef std::map<std::string,std::vector<std::string> > values_t;
+    Tracker_& tracker_;
+    std::string path_;
+    unsigned int period_; //ms
+    bool verbose_;
+    time_t mtime_;
+    off_t size_;
+    values_t values_;     //file content at the last read
+    bool stop_;
+    boost::mutex mutex_;
+    boost::condition_variable wake_;
+    boost::thread* thread_;
+    boost::atomic<unsigned long> applied_,refused_;
+    ConfigWatcher(const ConfigWatcher&);
+    ConfigWatcher& operator=(const ConfigWatcher&);
+    void run();
+    //parses name=value lines, repeated names accumulate their values like program_options does
+    static bool read(const std::string& path, values_t& values);
+  public:
+    //the current content of path is the reference, only later changes are applied
+    ConfigWatcher(Tracker_& tracker, const std::string& path, unsigned int period = 500, bool verbose = false);
+    ~ConfigWatcher();
+    void start();
+    void stop();
+    //checks the file once on the calling thread, when the watcher is not started. Returns true when a delta was accepted by the tracker
+    bool poll();
+
+    //metrics
+    unsigned long get_applied() const;
+    unsigned long get_refused() const;
+  };
+}
+#endif /* __CONFIG_WATCHER_H__ */
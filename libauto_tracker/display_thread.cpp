@@ -0,0 +1,178 @@
+#include "display_thread.h"
+#include <algorithm>
+#include <cmath>
+#include <visp/vpDisplay.h>
+#include <visp/vpColor.h>
+
+namespace tracking{
+  static const vpColor corner_colors[4] = { vpColor::blue, vpColor::yellow, vpColor::cyan, vpColor::darkRed };
+
+  //closed contour of a group of projected model points
+  static void display_contour(const vpImage<vpRGBa>& I, const ModelPoints& model_points, ModelPoints::group_t group, const vpColor& color){
+    unsigned int n = model_points.size(group);
+    for(unsigned int i=0;i<n;i++)
+      vpDisplay::displayLine(I,model_points.get_image_point(group,i),model_points.get_image_point(group,(i+1)%n),color,1);
+  }
+
+  DisplayThread:: DisplayThread(CmdLine& cmd, unsigned int decimation) :
+      cmd_(cmd),
+      decimation_(std::max(decimation,1u)),
+      back_(&slots_[0]),
+      pending_(&slots_[1]),
+      front_(&slots_[2]),
+      has_pending_(false),
+      stop_(false),
+      thread_(NULL),
+      display_(NULL),
+      plot_(NULL),
+      submitted_(0),
+      rendered_(0),
+      dropped_(0){
+  }
+
+  DisplayThread:: ~DisplayThread(){
+    stop();
+  }
+
+  void DisplayThread:: start(){
+    if(thread_)
+      return;
+    stop_ = false;
+    thread_ = new boost::thread(&DisplayThread::run,this);
+  }
+
+  void DisplayThread:: stop(){
+    if(!thread_)
+      return;
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    ready_.notify_one();
+    thread_->join();
+    delete thread_;
+    thread_ = NULL;
+  }
+
+  display_frame_t* DisplayThread:: begin_frame(int frame){
+    if(!thread_ || (unsigned int)frame%decimation_!=0)
+      return NULL;
+    return back_;
+  }
+
+  void DisplayThread:: submit(){
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      std::swap(back_,pending_);
+      if(has_pending_)
+        dropped_.fetch_add(1,boost::memory_order_relaxed);
+      has_pending_ = true;
+    }
+    submitted_.fetch_add(1,boost::memory_order_relaxed);
+    ready_.notify_one();
+  }
+
+  void DisplayThread:: run(){
+    for(;;){
+      {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        while(!has_pending_ && !stop_)
+          ready_.wait(lock);
+        if(!has_pending_)
+          break;
+        std::swap(pending_,front_);
+        has_pending_ = false;
+      }
+      render(*front_);
+      rendered_.fetch_add(1,boost::memory_order_relaxed);
+    }
+    //X11 resources belong to this thread
+    delete plot_;
+    plot_ = NULL;
+    delete display_;
+    display_ = NULL;
+  }
+
+  void DisplayThread:: render(display_frame_t& frame){
+    vpImage<vpRGBa>& I = frame.I;
+    if(display_ == NULL){
+      display_ = new vpDisplayX();
+      display_->init(I);
+    }
+    //slots take turns on the window
+    I.display = display_;
+    vpDisplay::display(I);
+
+    switch(frame.state){
+      case STATE_DETECT_FLASHCODE:
+      case STATE_REDETECT_FLASHCODE:
+        if(frame.nb_corners==4){
+          vpColor color = frame.state==STATE_DETECT_FLASHCODE ? vpColor::green : vpColor::orange;
+          for(unsigned int i=0;i<4;i++){
+            vpDisplay::displayLine(I,frame.corners[i],frame.corners[(i+1)%4],color,2);
+            vpDisplay::displayCross(I,frame.corners[i],4,corner_colors[i],2);
+          }
+        }
+        break;
+      case STATE_DETECT_MODEL:
+        for(unsigned int i=0;i<4 && i<frame.model_points.size(ModelPoints::INNER);i++){
+          vpDisplay::displayCross(I,frame.model_points.get_image_point(ModelPoints::INNER,i),2,corner_colors[i],2);
+          vpDisplay::displayCross(I,frame.model_points.get_image_point(ModelPoints::OUTER,i),2,corner_colors[i],2);
+        }
+        display_contour(I,frame.model_points,ModelPoints::INNER,vpColor::blue);
+        display_contour(I,frame.model_points,ModelPoints::OUTER,vpColor::blue);
+        break;
+      case STATE_TRACK_MODEL:
+        display_contour(I,frame.model_points,ModelPoints::INNER,vpColor::red);
+        display_contour(I,frame.model_points,ModelPoints::OUTER,vpColor::red);
+        vpDisplay::displayFrame(I,frame.result.cMo,frame.cam,.1,vpColor::none,2);
+        if(cmd_.using_adhoc_recovery() && cmd_.get_adhoc_recovery_display()){
+          const ModelPoints& model_points = frame.model_points;
+          for(unsigned int p=0;p<model_points.size(ModelPoints::MIDDLE);p++){
+            double _u = model_points.get_u(ModelPoints::MIDDLE,p),
+                   _v = model_points.get_v(ModelPoints::MIDDLE,p),
+                   _u_inner = model_points.get_u(ModelPoints::INNER,p),
+                   _v_inner = model_points.get_v(ModelPoints::INNER,p);
+            int region_width= std::max((int)(std::abs(_u-_u_inner)*cmd_.get_adhoc_recovery_size()),1);
+            int region_height=std::max((int)(std::abs(_v-_v_inner)*cmd_.get_adhoc_recovery_size()),1);
+            int u=(int)_u;
+            int v=(int)_v;
+            vpDisplay::displayRectangle(
+                I,
+                vpImagePoint(std::max(v-region_height,0),std::max(u-region_width,0)),
+                vpImagePoint(
+                    std::max(0, std::min(v+region_height,(int)I.getHeight())),
+                    std::max(0, std::min(u+region_width,(int)I.getWidth()))
+                ),
+                vpColor::cyan,
+                true
+                );
+          }
+        }
+        if(cmd_.show_plot()){
+          if(plot_ == NULL){
+            plot_ = new vpPlot(1, 700, 700, 100, 200, "Variances");
+            plot_->initGraph(0,7);
+          }
+          if(cmd_.using_var_limit())
+            plot_->plot(0,6,frame.result.frame,(double)cmd_.get_var_limit());
+          for(unsigned int i=0;i<6;i++)
+            plot_->plot(0,i,frame.result.frame,frame.result.covariance[i]);
+        }
+        break;
+    }
+    vpDisplay::flush(I);
+  }
+
+  unsigned long DisplayThread:: get_submitted() const{
+    return submitted_.load(boost::memory_order_relaxed);
+  }
+
+  unsigned long DisplayThread:: get_rendered() const{
+    return rendered_.load(boost::memory_order_relaxed);
+  }
+
+  unsigned long DisplayThread:: get_dropped() const{
+    return dropped_.load(boost::memory_order_relaxed);
+  }
+}
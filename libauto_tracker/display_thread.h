@@ -0,0 +1,76 @@
+#ifndef __DISPLAY_THREAD_H__
+#define __DISPLAY_THREAD_H__
+#include <boost/array.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+#include <visp/vpImagePoint.h>
+#include <visp/vpCameraParameters.h>
+#include <visp/vpDisplayX.h>
+#include <visp/vpPlot.h>
+#include "cmd_line/cmd_line.h"
+#include "pose_publisher.h"
+#include "tracking_result.h"
+#include "model_points.h"
+
+namespace tracking{
+  //everything the render thread needs to draw one frame, filled by the tracking thread
+  struct display_frame_t{
+    vpImage<vpRGBa> I;
+    tracker_state_t state;
+    TrackingResult result;
+    vpCameraParameters cam;
+    unsigned int nb_corners;
+    boost::array<vpImagePoint,4> corners; //detected pattern
+    ModelPoints model_points;             //projected at result.cMo
+  };
+
+  /*
+   * Renders tracked frames on its own thread and X11 window so that drawing and flushing
+   * stay off the tracking thread.
+   * Frames are triple buffered: the tracker fills one slot while the renderer draws another and the
+   * third holds the latest complete frame. A frame the renderer did not pick up before the next one
+   * was submitted is dropped, the view always shows the most recent frame.
+   */
+  class DisplayThread{
+  private:
+    CmdLine& cmd_;
+    unsigned int decimation_;
+    display_frame_t slots_[3];
+    display_frame_t* back_;    //filled by the tracking thread
+    display_frame_t* pending_; //latest submitted frame
+    display_frame_t* front_;   //drawn by the render thread
+    bool has_pending_;
+    bool stop_;
+    boost::mutex mutex_;
+    boost::condition_variable ready_;
+    boost::thread* thread_;
+    vpDisplayX* display_;
+    vpPlot* plot_;
+    boost::atomic<unsigned long> submitted_,rendered_,dropped_;
+
+    void run();
+    void render(display_frame_t& frame);
+  public:
+    //renders one frame out of decimation
+    DisplayThread(CmdLine& cmd, unsigned int decimation = 1);
+    ~DisplayThread();
+    void start();
+    //renders the frame already submitted if any and stops the thread
+    void stop();
+
+    //tracking thread side: returns the slot to fill for this frame,
+    //NULL when the thread is not running or the frame is decimated out
+    display_frame_t* begin_frame(int frame);
+    //hands the slot returned by begin_frame to the renderer
+    void submit();
+
+    //metrics
+    unsigned long get_submitted() const;
+    unsigned long get_rendered() const;
+    //frames replaced by a newer one before the renderer picked them up
+    unsigned long get_dropped() const;
+  };
+}
+#endif /* __DISPLAY_THREAD_H__ */
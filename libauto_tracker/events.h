@@ -2,15 +2,21 @@
 #define __TEVENTS_H__
 #include <visp/vpImage.h>
 #include <visp/vpCameraParameters.h>
+#include <visp/vpTime.h>
 
 namespace tracking{
 
   struct input_ready{
-    input_ready(vpImage<vpRGBa>& I,vpCameraParameters& cam) : I(I),cam_(cam),frame(0){}
-    input_ready(vpImage<vpRGBa>& I,vpCameraParameters& cam,int frame) : I(I),cam_(cam),frame(frame){}
+    input_ready(vpImage<vpRGBa>& I,vpCameraParameters& cam) : I(I),gray(NULL),cam_(cam),frame(0),timestamp(vpTime::measureTimeMs()){}
+    input_ready(vpImage<vpRGBa>& I,vpCameraParameters& cam,int frame) : I(I),gray(NULL),cam_(cam),frame(frame),timestamp(vpTime::measureTimeMs()){}
+    input_ready(vpImage<vpRGBa>& I,vpCameraParameters& cam,int frame,double timestamp) : I(I),gray(NULL),cam_(cam),frame(frame),timestamp(timestamp){}
+    //the frame is given as luminance, I is only used for display and may be stale but must have the same size
+    input_ready(vpImage<vpRGBa>& I,const vpImage<unsigned char>& gray,vpCameraParameters& cam,int frame,double timestamp) : I(I),gray(&gray),cam_(cam),frame(frame),timestamp(timestamp){}
     vpImage<vpRGBa>& I;
+    const vpImage<unsigned char>* gray; //NULL when the tracker has to convert I
     vpCameraParameters cam_;
     int frame;
+    double timestamp; //acquisition time in ms
   };
   struct select_input{
     select_input(vpImage<vpRGBa>& I) : I(I){}
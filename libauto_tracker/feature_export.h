@@ -0,0 +1,31 @@
+#ifndef __FEATURE_EXPORT_H__
+#define __FEATURE_EXPORT_H__
+#include <vector>
+
+namespace tracking{
+  /*
+   * Caller-owned feature buffers, stored as structure of arrays.
+   * clear() keeps the capacity, so once the buffers have grown to the usual feature count
+   * exporting into them does not allocate anymore.
+   */
+  struct moving_edge_sites_t{
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<int> suppress;
+
+    void reserve(unsigned int n){ x.reserve(n); y.reserve(n); suppress.reserve(n); }
+    void clear(){ x.clear(); y.clear(); suppress.clear(); }
+    unsigned int size() const{ return (unsigned int)x.size(); }
+  };
+
+  struct klt_points_t{
+    std::vector<int> id;
+    std::vector<double> i;
+    std::vector<double> j;
+
+    void reserve(unsigned int n){ id.reserve(n); i.reserve(n); j.reserve(n); }
+    void clear(){ id.clear(); i.clear(); j.clear(); }
+    unsigned int size() const{ return (unsigned int)id.size(); }
+  };
+}
+#endif /* __FEATURE_EXPORT_H__ */
@@ -0,0 +1,113 @@
+#include "frame_budget.h"
+#include <algorithm>
+#include <visp/vpTime.h>
+
+namespace tracking{
+  FrameBudget:: FrameBudget(double budget) :
+      budget_(budget),
+      in_frame_(false),
+      frame_start_(0.),
+      last_end_(0.),
+      in_stage_(false),
+      stage_(STAGE_CONVERSION),
+      stage_start_(0.),
+      stage_deadline_(0.),
+      rollover_(0.),
+      frames_(0),
+      overruns_(0){
+    for(unsigned int i=0;i<NB_STAGES;i++)
+      spent_[i] = 0.;
+  }
+
+  bool FrameBudget:: enabled() const{
+    return budget_>0.;
+  }
+
+  double FrameBudget:: get_budget() const{
+    return budget_;
+  }
+
+  void FrameBudget:: end_frame(){
+    end_stage();
+    if(!in_frame_)
+      return;
+    in_frame_ = false;
+    frames_++;
+    if(!enabled())
+      return;
+    double unused = budget_ - (last_end_-frame_start_);
+    if(unused<0.)
+      overruns_++;
+    else
+      rollover_ = std::min(rollover_+unused,budget_);
+  }
+
+  void FrameBudget:: begin_frame(){
+    end_frame();
+    in_frame_ = true;
+    frame_start_ = last_end_ = vpTime::measureTimeMs();
+  }
+
+  void FrameBudget:: begin_stage(stage_t stage){
+    end_stage();
+    in_stage_ = true;
+    stage_ = stage;
+    stage_start_ = vpTime::measureTimeMs();
+    //what the detector may take beyond the frame comes from the rollover
+    stage_deadline_ = remaining();
+  }
+
+  void FrameBudget:: end_stage(){
+    if(!in_stage_)
+      return;
+    in_stage_ = false;
+    last_end_ = vpTime::measureTimeMs();
+    double spent = last_end_-stage_start_;
+    spent_[stage_] += spent;
+    if(stage_==STAGE_DETECTION && enabled())
+      rollover_ = std::max(0.,rollover_ - std::max(0.,spent-std::max(0.,stage_deadline_)));
+  }
+
+  double FrameBudget:: remaining() const{
+    return budget_ - (vpTime::measureTimeMs()-frame_start_);
+  }
+
+  bool FrameBudget:: exhausted() const{
+    return enabled() && remaining()<=0.;
+  }
+
+  double FrameBudget:: get_detection_deadline() const{
+    return std::max(0.,remaining()) + rollover_;
+  }
+
+  unsigned int FrameBudget:: get_frames() const{
+    return frames_;
+  }
+
+  unsigned int FrameBudget:: get_overruns() const{
+    return overruns_;
+  }
+
+  double FrameBudget:: get_mean_time(stage_t stage) const{
+    return frames_>0 ? spent_[stage]/frames_ : 0.;
+  }
+
+  double FrameBudget:: get_rollover() const{
+    return rollover_;
+  }
+
+  const char* FrameBudget:: get_stage_name(stage_t stage){
+    switch(stage){
+      case STAGE_CONVERSION:
+        return "conversion";
+      case STAGE_DETECTION:
+        return "detection";
+      case STAGE_MODEL_INIT:
+        return "model initialisation";
+      case STAGE_TRACKING:
+        return "tracking";
+      default:
+        return "unknown";
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef __FRAME_BUDGET_H__
+#define __FRAME_BUDGET_H__
+
+namespace tracking{
+  /*
+   * Time budget of one frame shared by the stages the tracker runs on it.
+   * Each stage is given what is left of the frame as its deadline. Time a frame did not use is kept
+   * (up to one whole budget) and only handed to the detector, so that a recovery can take longer
+   * without pushing the following tracked frames past their deadlines.
+   */
+  class FrameBudget{
+  public:
+    enum stage_t{
+      STAGE_CONVERSION,
+      STAGE_DETECTION,
+      STAGE_MODEL_INIT,
+      STAGE_TRACKING,
+      NB_STAGES
+    };
+  private:
+    double budget_;
+    bool in_frame_;
+    double frame_start_;
+    double last_end_;
+    bool in_stage_;
+    stage_t stage_;
+    double stage_start_;
+    double stage_deadline_;
+    double rollover_;
+    double spent_[NB_STAGES];
+    unsigned int frames_;
+    unsigned int overruns_;
+  public:
+    //budget in ms, 0 disables deadlines
+    FrameBudget(double budget = 0.);
+    bool enabled() const;
+    double get_budget() const;
+    //starts a new frame, the previous one is closed at the end of its last stage if end_frame() was not called
+    void begin_frame();
+    //closes the current stage and the frame, nothing happens when no frame is open
+    void end_frame();
+    //closes the current stage if any and starts the given one
+    void begin_stage(stage_t stage);
+    void end_stage();
+    //ms left in the current frame, may be negative
+    double remaining() const;
+    //true when the frame used its whole budget
+    bool exhausted() const;
+    //ms the detector may use: what is left of the frame plus the time unused by previous frames
+    double get_detection_deadline() const;
+
+    //metrics
+    unsigned int get_frames() const;
+    unsigned int get_overruns() const;
+    //mean time spent in a stage per frame, in ms
+    double get_mean_time(stage_t stage) const;
+    double get_rollover() const;
+    static const char* get_stage_name(stage_t stage);
+  };
+}
+#endif /* __FRAME_BUDGET_H__ */
@@ -0,0 +1,98 @@
+#include "model_points.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tracking{
+  ModelPoints:: ModelPoints() : projected_(false){
+    for(unsigned int g=0;g<=NB_GROUPS;g++)
+      begin_[g] = 0;
+  }
+
+  void ModelPoints:: assign(const std::vector<vpPoint>& inner, const std::vector<vpPoint>& outer, const std::vector<vpPoint>& middle){
+    const std::vector<vpPoint>* groups[NB_GROUPS] = {&inner,&outer,&middle};
+    oX_.clear();
+    oY_.clear();
+    oZ_.clear();
+    for(unsigned int g=0;g<NB_GROUPS;g++){
+      begin_[g] = (unsigned int)oX_.size();
+      for(unsigned int i=0;i<groups[g]->size();i++){
+        oX_.push_back((*groups[g])[i].get_oX());
+        oY_.push_back((*groups[g])[i].get_oY());
+        oZ_.push_back((*groups[g])[i].get_oZ());
+      }
+    }
+    begin_[NB_GROUPS] = (unsigned int)oX_.size();
+    x_.assign(oX_.size(),0.);
+    y_.assign(oX_.size(),0.);
+    u_.assign(oX_.size(),0.);
+    v_.assign(oX_.size(),0.);
+    invalidate();
+  }
+
+  void ModelPoints:: invalidate(){
+    projected_ = false;
+  }
+
+  bool ModelPoints:: same_projection(const vpHomogeneousMatrix& cMo, const vpCameraParameters& cam) const{
+    if(!projected_)
+      return false;
+    for(unsigned int i=0;i<3;i++)
+      for(unsigned int j=0;j<4;j++)
+        if(cMo_[i*4+j] != cMo[i][j])
+          return false;
+    return cam_[0] == cam.get_px() && cam_[1] == cam.get_py() && cam_[2] == cam.get_u0() && cam_[3] == cam.get_v0()
+        && cam_[4] == (cam.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion ? cam.get_kud() : 0.);
+  }
+
+  void ModelPoints:: project(const vpHomogeneousMatrix& cMo, const vpCameraParameters& cam){
+    if(same_projection(cMo,cam))
+      return;
+    for(unsigned int i=0;i<3;i++)
+      for(unsigned int j=0;j<4;j++)
+        cMo_[i*4+j] = cMo[i][j];
+    cam_[0] = cam.get_px();
+    cam_[1] = cam.get_py();
+    cam_[2] = cam.get_u0();
+    cam_[3] = cam.get_v0();
+    //same model as vpMeterPixelConversion: u = u0 + px*x*(1+kud*r2)
+    cam_[4] = cam.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion ? cam.get_kud() : 0.;
+    projected_ = true;
+
+    const double* m = cMo_;
+    const unsigned int n = (unsigned int)oX_.size();
+    unsigned int i = 0;
+#if defined(__SSE2__)
+    //two points per iteration
+    const __m128d r00 = _mm_set1_pd(m[0]), r01 = _mm_set1_pd(m[1]), r02 = _mm_set1_pd(m[2]), tx = _mm_set1_pd(m[3]);
+    const __m128d r10 = _mm_set1_pd(m[4]), r11 = _mm_set1_pd(m[5]), r12 = _mm_set1_pd(m[6]), ty = _mm_set1_pd(m[7]);
+    const __m128d r20 = _mm_set1_pd(m[8]), r21 = _mm_set1_pd(m[9]), r22 = _mm_set1_pd(m[10]), tz = _mm_set1_pd(m[11]);
+    const __m128d px = _mm_set1_pd(cam_[0]), py = _mm_set1_pd(cam_[1]), u0 = _mm_set1_pd(cam_[2]), v0 = _mm_set1_pd(cam_[3]);
+    const __m128d kud = _mm_set1_pd(cam_[4]), one = _mm_set1_pd(1.);
+    for(;i+2<=n;i+=2){
+      __m128d oX = _mm_loadu_pd(&oX_[i]), oY = _mm_loadu_pd(&oY_[i]), oZ = _mm_loadu_pd(&oZ_[i]);
+      __m128d X = _mm_add_pd(_mm_add_pd(_mm_mul_pd(r00,oX),_mm_mul_pd(r01,oY)),_mm_add_pd(_mm_mul_pd(r02,oZ),tx));
+      __m128d Y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(r10,oX),_mm_mul_pd(r11,oY)),_mm_add_pd(_mm_mul_pd(r12,oZ),ty));
+      __m128d Z = _mm_add_pd(_mm_add_pd(_mm_mul_pd(r20,oX),_mm_mul_pd(r21,oY)),_mm_add_pd(_mm_mul_pd(r22,oZ),tz));
+      __m128d x = _mm_div_pd(X,Z), y = _mm_div_pd(Y,Z);
+      __m128d r2 = _mm_add_pd(_mm_mul_pd(x,x),_mm_mul_pd(y,y));
+      __m128d d = _mm_add_pd(one,_mm_mul_pd(kud,r2));
+      _mm_storeu_pd(&x_[i],x);
+      _mm_storeu_pd(&y_[i],y);
+      _mm_storeu_pd(&u_[i],_mm_add_pd(u0,_mm_mul_pd(_mm_mul_pd(px,x),d)));
+      _mm_storeu_pd(&v_[i],_mm_add_pd(v0,_mm_mul_pd(_mm_mul_pd(py,y),d)));
+    }
+#endif
+    for(;i<n;i++){
+      double X = m[0]*oX_[i] + m[1]*oY_[i] + m[2]*oZ_[i] + m[3];
+      double Y = m[4]*oX_[i] + m[5]*oY_[i] + m[6]*oZ_[i] + m[7];
+      double Z = m[8]*oX_[i] + m[9]*oY_[i] + m[10]*oZ_[i] + m[11];
+      double x = X/Z, y = Y/Z;
+      double d = 1. + cam_[4]*(x*x + y*y);
+      x_[i] = x;
+      y_[i] = y;
+      u_[i] = cam_[2] + cam_[0]*x*d;
+      v_[i] = cam_[3] + cam_[1]*y*d;
+    }
+  }
+}
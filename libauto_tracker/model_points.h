@@ -0,0 +1,43 @@
+#ifndef __MODEL_POINTS_H__
+#define __MODEL_POINTS_H__
+#include <vector>
+#include <visp/vpPoint.h>
+#include <visp/vpImagePoint.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpCameraParameters.h>
+
+namespace tracking{
+  /*
+   * The inner, outer and middle contours of the pattern stored as structure of arrays.
+   * project() computes the normalised and pixel coordinates of all points in one pass (SSE2 when available)
+   * and returns immediately when the pose and camera did not change since the last call,
+   * so every consumer of a frame can call it and share the same result.
+   */
+  class ModelPoints{
+  public:
+    enum group_t{ INNER = 0, OUTER = 1, MIDDLE = 2 };
+  private:
+    static const unsigned int NB_GROUPS = 3;
+    unsigned int begin_[NB_GROUPS+1];
+    std::vector<double> oX_,oY_,oZ_;
+    std::vector<double> x_,y_,u_,v_;
+    bool projected_;
+    double cMo_[12];
+    double cam_[5];
+    bool same_projection(const vpHomogeneousMatrix& cMo, const vpCameraParameters& cam) const;
+  public:
+    ModelPoints();
+    void assign(const std::vector<vpPoint>& inner, const std::vector<vpPoint>& outer, const std::vector<vpPoint>& middle);
+    void project(const vpHomogeneousMatrix& cMo, const vpCameraParameters& cam);
+    //forgets the last projection, the next project() call recomputes everything
+    void invalidate();
+
+    unsigned int size(group_t group) const{ return begin_[group+1]-begin_[group]; }
+    double get_x(group_t group, unsigned int i) const{ return x_[begin_[group]+i]; }
+    double get_y(group_t group, unsigned int i) const{ return y_[begin_[group]+i]; }
+    double get_u(group_t group, unsigned int i) const{ return u_[begin_[group]+i]; }
+    double get_v(group_t group, unsigned int i) const{ return v_[begin_[group]+i]; }
+    vpImagePoint get_image_point(group_t group, unsigned int i) const{ return vpImagePoint(get_v(group,i),get_u(group,i)); }
+  };
+}
+#endif /* __MODEL_POINTS_H__ */
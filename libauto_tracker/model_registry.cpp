@@ -0,0 +1,141 @@
+#include "model_registry.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <visp/vpMbEdgeKltTracker.h>
+#include <visp/vpMbKltTracker.h>
+#include <visp/vpMbEdgeTracker.h>
+#include "parallel_hybrid.h"
+
+namespace tracking{
+  boost::mutex& get_model_loading_mutex(){
+    static boost::mutex mutex;
+    return mutex;
+  }
+
+  ModelRegistry:: ModelRegistry(CmdLine& cmd, unsigned int capacity) :
+      cmd_(cmd),
+      capacity_(std::max(capacity,1u)),
+      loads_(0),
+      hits_(0){
+  }
+
+  ModelRegistry:: ~ModelRegistry(){
+    for(std::list<pattern_t*>::iterator i = cache_.begin();i!=cache_.end();i++){
+      delete (*i)->tracker;
+      delete *i;
+    }
+  }
+
+  unsigned int ModelRegistry:: load_index(const std::string& path){
+    std::ifstream in(path.c_str());
+    std::string line;
+    unsigned int entries = 0;
+    while(std::getline(in,line)){
+      std::istringstream fields(line);
+      std::string payload,config_file;
+      if(!(fields >> payload) || payload[0]=='#')
+        continue;
+      if(!(fields >> config_file)){
+        std::cout << "model registry: no config file for payload " << payload << std::endl;
+        continue;
+      }
+      add(payload,config_file);
+      entries++;
+    }
+    return entries;
+  }
+
+  void ModelRegistry:: add(const std::string& payload, const std::string& config_file){
+    configs_[payload] = config_file;
+  }
+
+  bool ModelRegistry:: has(const std::string& payload) const{
+    return configs_.count(payload)>0;
+  }
+
+  pattern_t* ModelRegistry:: get(const std::string& payload){
+    for(std::list<pattern_t*>::iterator i = cache_.begin();i!=cache_.end();i++){
+      if((*i)->payload!=payload)
+        continue;
+      pattern_t* pattern = *i;
+      cache_.splice(cache_.begin(),cache_,i);
+      hits_++;
+      return pattern;
+    }
+
+    std::map<std::string,std::string>::const_iterator config = configs_.find(payload);
+    if(config==configs_.end())
+      return NULL;
+    pattern_t* pattern = load(payload,cmd_.get_data_dir() + config->second);
+    if(!pattern)
+      return NULL;
+
+    while(cache_.size()>=capacity_){
+      delete cache_.back()->tracker;
+      delete cache_.back();
+      cache_.pop_back();
+    }
+    cache_.push_front(pattern);
+    return pattern;
+  }
+
+  pattern_t* ModelRegistry:: load(const std::string& payload, std::string config_file){
+    if(cmd_.get_verbose())
+      std::cout << "model registry: loading " << config_file << " for payload " << payload << std::endl;
+    CmdLine definition(config_file);
+    //the flashcode pose is computed from its 4 corners, and inner and outer points are paired one to one
+    if(definition.get_flashcode_points_3D().size()!=4){
+      std::cout << "model registry: payload " << payload << " needs 4 flashcode points, " << config_file << " has " << definition.get_flashcode_points_3D().size() << std::endl;
+      return NULL;
+    }
+    if(definition.get_inner_points_3D().empty() || definition.get_inner_points_3D().size()!=definition.get_outer_points_3D().size()){
+      std::cout << "model registry: payload " << payload << " needs as many inner as outer points, and at least one, " << config_file << " has "
+                << definition.get_inner_points_3D().size() << " inner and " << definition.get_outer_points_3D().size() << " outer points" << std::endl;
+      return NULL;
+    }
+    pattern_t* pattern = new pattern_t;
+    pattern->payload = payload;
+    pattern->xml_file = cmd_.get_data_dir() + definition.get_pattern_name() + std::string(".xml");
+    pattern->wrl_file = cmd_.get_data_dir() + definition.get_pattern_name() + std::string(".wrl");
+    pattern->flashcode = definition.get_flashcode_points_3D();
+    pattern->inner = definition.get_inner_points_3D();
+    pattern->outer = definition.get_outer_points_3D();
+    pattern->tracker = create_tracker(cmd_.get_tracker_type());
+    try{
+      boost::mutex::scoped_lock lock(get_model_loading_mutex());
+      pattern->tracker->loadConfigFile(pattern->xml_file.c_str());
+      pattern->tracker->loadModel(pattern->wrl_file.c_str());
+    }catch(vpException& e){
+      std::cout << "model registry: cannot load the model of payload " << payload << ": " << e.getStringMessage() << std::endl;
+      delete pattern->tracker;
+      delete pattern;
+      return NULL;
+    }
+    loads_++;
+    return pattern;
+  }
+
+  unsigned int ModelRegistry:: get_loads() const{
+    return loads_;
+  }
+
+  unsigned int ModelRegistry:: get_hits() const{
+    return hits_;
+  }
+
+  vpMbTracker* ModelRegistry:: create_tracker(CmdLine::TRACKER_TYPE type){
+    switch(type){
+      case CmdLine::KLT:
+        return new vpMbKltTracker();
+      case CmdLine::MBT:
+        return new vpMbEdgeTracker();
+      case CmdLine::KLT_MBT_PARALLEL:
+        return new ParallelHybridTracker();
+      case CmdLine::KLT_MBT:
+      default:
+        return new vpMbEdgeKltTracker();
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef __MODEL_REGISTRY_H__
+#define __MODEL_REGISTRY_H__
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <boost/thread/mutex.hpp>
+#include <visp/vpPoint.h>
+#include <visp/vpMbTracker.h>
+#include "cmd_line/cmd_line.h"
+
+namespace tracking{
+  //model loading goes through coin and libxml which are not thread safe.
+  //Every tracker and registry of the process loads under this mutex
+  boost::mutex& get_model_loading_mutex();
+
+  //a pattern definition and the visp tracker loaded with its model
+  struct pattern_t{
+    std::string payload;
+    std::string xml_file;
+    std::string wrl_file;
+    std::vector<vpPoint> flashcode;
+    std::vector<vpPoint> inner;
+    std::vector<vpPoint> outer;
+    vpMbTracker* tracker; //owned by the registry
+  };
+
+  /*
+   * Maps symbol payloads to pattern config files (same format as --config-file, only pattern-name and
+   * the flashcode/inner/outer coordinates are read).
+   * Patterns are loaded the first time their payload is asked for and kept with a ready to use tracker
+   * in a least recently used cache, so going back to a recent pattern costs no loading.
+   */
+  class ModelRegistry{
+  private:
+    CmdLine& cmd_;
+    unsigned int capacity_;
+    std::map<std::string,std::string> configs_; //payload -> config file
+    std::list<pattern_t*> cache_;               //most recently used first
+    unsigned int loads_,hits_;
+    ModelRegistry(const ModelRegistry&);
+    ModelRegistry& operator=(const ModelRegistry&);
+    pattern_t* load(const std::string& payload, std::string config_file);
+  public:
+    //cmd gives the data directory and the tracker type, capacity is the number of loaded patterns kept
+    ModelRegistry(CmdLine& cmd, unsigned int capacity = 4);
+    ~ModelRegistry();
+    //reads an index file with one "payload config_file" pair per line, config files relative to the data directory.
+    //Empty lines and lines starting with # are skipped. Returns the number of entries read
+    unsigned int load_index(const std::string& path);
+    void add(const std::string& payload, const std::string& config_file);
+    bool has(const std::string& payload) const;
+    //returns the pattern for payload, loading it if needed and evicting the least recently used one.
+    //NULL when the payload is unknown. The pointer is valid until the pattern is evicted
+    pattern_t* get(const std::string& payload);
+
+    //metrics
+    unsigned int get_loads() const;
+    unsigned int get_hits() const;
+
+    //creates a visp tracker of the type given on the command line
+    static vpMbTracker* create_tracker(CmdLine::TRACKER_TYPE type);
+  };
+}
+#endif /* __MODEL_REGISTRY_H__ */
@@ -0,0 +1,271 @@
+#include "monitors.h"
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+namespace tracking{
+  static double variance_sum(const TrackingResult& result){
+    double sum = 0.;
+    for(unsigned int i=0;i<result.nb_covariance;i++)
+      sum += result.covariance[i];
+    return sum;
+  }
+
+  void pose_difference(const vpHomogeneousMatrix& a, const vpHomogeneousMatrix& b, double& translation, double& rotation){
+    //computed on the matrix elements: visp matrix temporaries would allocate on every frame
+    //the translation of a^-1*b is a rotation of tb-ta, its norm is the distance between the origins
+    double dx = b[0][3]-a[0][3],
+           dy = b[1][3]-a[1][3],
+           dz = b[2][3]-a[2][3];
+    translation = std::sqrt(dx*dx+dy*dy+dz*dz);
+    //rotation of a^-1*b: R = Ra^T*Rb, its angle from the trace and the antisymmetric part
+    double R[3][3];
+    for(unsigned int i=0;i<3;i++)
+      for(unsigned int j=0;j<3;j++)
+        R[i][j] = a[0][i]*b[0][j] + a[1][i]*b[1][j] + a[2][i]*b[2][j];
+    double sx = R[2][1]-R[1][2],
+           sy = R[0][2]-R[2][0],
+           sz = R[1][0]-R[0][1];
+    double s = 0.5*std::sqrt(sx*sx+sy*sy+sz*sz),
+           c = 0.5*(R[0][0]+R[1][1]+R[2][2]-1.);
+    rotation = std::atan2(s,c);
+  }
+
+  VarLimitMonitor:: VarLimitMonitor(double limit) : limit_(limit){
+  }
+
+  void VarLimitMonitor:: set_limit(double limit){
+    limit_ = limit;
+  }
+
+  Monitor::outcome_t VarLimitMonitor:: check(frame_context_t& frame){
+    for(unsigned int i=0;i<6;i++)
+      if(frame.result.covariance[i]>limit_)
+        return FAIL;
+    return PASS;
+  }
+
+  HinkleyMonitor:: HinkleyMonitor(double alpha, double delta){
+    for(unsigned int i=0;i<hink_.size();i++)
+      hink_[i].init(alpha,delta);
+  }
+
+  void HinkleyMonitor:: set_range(double alpha, double delta){
+    for(unsigned int i=0;i<hink_.size();i++){
+      hink_[i].setAlpha(alpha);
+      hink_[i].setDelta(delta);
+    }
+  }
+
+  Monitor::outcome_t HinkleyMonitor:: check(frame_context_t& frame){
+    for(unsigned int i=0;i<6;i++)
+      if(hink_[i].testDownUpwardJump(frame.result.covariance[i]) != vpHinkley::noJump)
+        return FAIL;
+    return PASS;
+  }
+
+  CusumMonitor:: CusumMonitor(double k, double h) : k_(k),h_(h){
+    reset();
+  }
+
+  void CusumMonitor:: reset(){
+    nb_ = 0;
+    reference_ = 0.;
+    sum_ = 0.;
+  }
+
+  Monitor::outcome_t CusumMonitor:: check(frame_context_t& frame){
+    double x = variance_sum(frame.result);
+    if(nb_<WARMUP){
+      reference_ += (x-reference_)/++nb_;
+      return PASS;
+    }
+    if(reference_<=0.)
+      return PASS;
+    sum_ = std::max(0.,sum_ + x/reference_ - 1. - k_);
+    if(sum_>=h_)
+      return FAIL;
+    return sum_>=h_/2 ? DRIFT : PASS;
+  }
+
+  EwmaMonitor:: EwmaMonitor(double lambda, double width) : lambda_(lambda),width_(width){
+    reset();
+  }
+
+  void EwmaMonitor:: reset(){
+    nb_ = 0;
+    mean_ = 0.;
+    var_ = 0.;
+  }
+
+  Monitor::outcome_t EwmaMonitor:: check(frame_context_t& frame){
+    double x = variance_sum(frame.result);
+    double d = x-mean_;
+    bool drift = nb_>=WARMUP && d>width_*std::sqrt(var_);
+    if(nb_<WARMUP){
+      //plain running mean and variance until the weighted ones are meaningful
+      nb_++;
+      mean_ += d/nb_;
+      var_ += (d*(x-mean_)-var_)/nb_;
+    }else{
+      mean_ += lambda_*d;
+      var_ = (1.-lambda_)*(var_ + lambda_*d*d);
+    }
+    return drift ? DRIFT : PASS;
+  }
+
+  PoseJumpMonitor:: PoseJumpMonitor(double max_translation, double max_rotation) :
+      max_translation_(max_translation),
+      max_rotation_(max_rotation),
+      has_previous_(false){
+  }
+
+  void PoseJumpMonitor:: reset(){
+    has_previous_ = false;
+  }
+
+  void PoseJumpMonitor:: seed_pose(const vpHomogeneousMatrix& cMo){
+    previous_ = cMo;
+    has_previous_ = true;
+  }
+
+  Monitor::outcome_t PoseJumpMonitor:: check(frame_context_t& frame){
+    if(has_previous_){
+      double translation,rotation;
+      pose_difference(previous_,frame.result.cMo,translation,rotation);
+      if(translation>max_translation_ || rotation>max_rotation_)
+        return FAIL;
+    }
+    previous_ = frame.result.cMo;
+    has_previous_ = true;
+    return PASS;
+  }
+
+  CheckpointMonitor:: CheckpointMonitor(double size, unsigned int threshold, bool enforce, summary_accumulator_t& pixels) :
+      size_(size),
+      threshold_(threshold),
+      enforce_(enforce),
+      pixels_(pixels){
+  }
+
+  void CheckpointMonitor:: set_size(double size){
+    size_ = size;
+  }
+
+  void CheckpointMonitor:: set_threshold(unsigned int threshold){
+    threshold_ = threshold;
+  }
+
+  Monitor::outcome_t CheckpointMonitor:: check(frame_context_t& frame){
+    frame.model_points.project(frame.result.cMo,frame.cam);
+    const ModelPoints& points = frame.model_points;
+    for(unsigned int p=0;p<points.size(ModelPoints::MIDDLE) && p<TrackingResult::MAX_CHECKPOINTS;p++){
+      double _u = points.get_u(ModelPoints::MIDDLE,p),
+             _v = points.get_v(ModelPoints::MIDDLE,p),
+             _u_inner = points.get_u(ModelPoints::INNER,p),
+             _v_inner = points.get_v(ModelPoints::INNER,p);
+
+      boost::accumulators::accumulator_set<
+              unsigned char,
+              boost::accumulators::stats<
+                boost::accumulators::tag::median(boost::accumulators::with_p_square_quantile)
+              >
+            > acc;
+
+      int region_width= std::max((int)(std::abs(_u-_u_inner)*size_),1);
+      int region_height=std::max((int)(std::abs(_v-_v_inner)*size_),1);
+      int u=(int)_u;
+      int v=(int)_v;
+      for(int i=std::max(u-region_width,0);
+          i<std::min(u+region_width,(int)frame.I.getWidth());
+          i++){
+        for(int j=std::max(v-region_height,0);
+            j<std::min(v+region_height,(int)frame.I.getHeight());
+            j++){
+          acc(frame.I[j][i]);
+          pixels_(frame.I[j][i]);
+        }
+      }
+      double checkpoints_median = boost::accumulators::median(acc);
+      frame.result.checkpoint_medians[frame.result.nb_checkpoints++] = checkpoints_median;
+      if( enforce_ && (unsigned int)checkpoints_median>threshold_ )
+        return FAIL;
+    }
+    return PASS;
+  }
+
+  MonitorChain:: MonitorChain() : period_(1),since_expensive_(0),expensive_enabled_(true),verbose_(false){
+  }
+
+  MonitorChain:: ~MonitorChain(){
+    for(std::vector<Monitor*>::iterator i = monitors_.begin();i!=monitors_.end();i++)
+      delete *i;
+  }
+
+  void MonitorChain:: set_period(unsigned int period){
+    period_ = std::max(period,1u);
+  }
+
+  void MonitorChain:: set_verbose(bool verbose){
+    verbose_ = verbose;
+  }
+
+  void MonitorChain:: set_expensive_enabled(bool enabled){
+    expensive_enabled_ = enabled;
+  }
+
+  void MonitorChain:: add(Monitor* monitor){
+    //keep monitors sorted by cost, in insertion order for a same cost
+    std::vector<Monitor*>::iterator i = monitors_.begin();
+    while(i!=monitors_.end() && (*i)->get_cost()<=monitor->get_cost())
+      i++;
+    monitors_.insert(i,monitor);
+  }
+
+  Monitor* MonitorChain:: find(const std::string& name){
+    for(std::vector<Monitor*>::iterator i = monitors_.begin();i!=monitors_.end();i++)
+      if(name==(*i)->get_name())
+        return *i;
+    return NULL;
+  }
+
+  TrackingResult::verdict_t MonitorChain:: run(frame_context_t& frame, bool over_budget){
+    bool drift = false;
+    since_expensive_++;
+    for(std::vector<Monitor*>::iterator i = monitors_.begin();i!=monitors_.end();i++){
+      if((*i)->get_cost()==Monitor::COST_IMAGE){
+        if(!expensive_enabled_ || (!drift && (since_expensive_<period_ || over_budget)))
+          continue;
+        since_expensive_ = 0;
+      }
+      switch((*i)->check(frame)){
+        case Monitor::FAIL:
+          if(verbose_)
+            std::cout << (*i)->get_name() << ": tracking lost" << std::endl;
+          return (*i)->get_verdict();
+        case Monitor::DRIFT:
+          if(verbose_ && !drift)
+            std::cout << (*i)->get_name() << ": drift detected" << std::endl;
+          drift = true;
+          break;
+        case Monitor::PASS:
+          break;
+      }
+    }
+    return TrackingResult::TRACKING_OK;
+  }
+
+  void MonitorChain:: reset(){
+    //expensive monitors are due on the first frame after initialisation
+    since_expensive_ = period_;
+    for(std::vector<Monitor*>::iterator i = monitors_.begin();i!=monitors_.end();i++)
+      (*i)->reset();
+  }
+
+  void MonitorChain:: seed_pose(const vpHomogeneousMatrix& cMo){
+    //a pose that did not come from the previous frame gets every test
+    since_expensive_ = period_;
+    for(std::vector<Monitor*>::iterator i = monitors_.begin();i!=monitors_.end();i++)
+      (*i)->seed_pose(cMo);
+  }
+}
@@ -0,0 +1,200 @@
+#ifndef __MONITORS_H__
+#define __MONITORS_H__
+#include <vector>
+#include <string>
+#include <boost/array.hpp>
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics.hpp>
+#include <boost/accumulators/statistics/median.hpp>
+#include <boost/accumulators/statistics/p_square_quantile.hpp>
+#include <visp/vpImage.h>
+#include <visp/vpHinkley.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpCameraParameters.h>
+
+#include "tracking_result.h"
+#include "model_points.h"
+
+namespace tracking{
+  typedef boost::accumulators::accumulator_set<
+    double,
+    boost::accumulators::stats<
+      boost::accumulators::tag::median(boost::accumulators::with_p_square_quantile),
+      boost::accumulators::tag::max,
+      boost::accumulators::tag::mean
+    >
+  > summary_accumulator_t;
+
+  //norms of the translation (m) and rotation (rad) taking pose a to pose b
+  void pose_difference(const vpHomogeneousMatrix& a, const vpHomogeneousMatrix& b, double& translation, double& rotation);
+
+  //what a monitor may look at to judge a tracked frame
+  struct frame_context_t{
+    TrackingResult& result;
+    const vpImage<unsigned char>& I;
+    ModelPoints& model_points;
+    const vpCameraParameters& cam;
+    frame_context_t(TrackingResult& result, const vpImage<unsigned char>& I, ModelPoints& model_points, const vpCameraParameters& cam) :
+      result(result), I(I), model_points(model_points), cam(cam){}
+  };
+
+  /*
+   * One tracking quality test.
+   * A monitor says whether the frame passes, whether it starts drifting (expensive monitors are then run
+   * even if they are not due) or whether tracking is lost.
+   */
+  class Monitor{
+  public:
+    enum cost_t{
+      COST_SCALAR, //a few operations on the covariance
+      COST_POSE,   //matrix operations on the pose
+      COST_IMAGE   //reads image pixels, only run periodically, see MonitorChain
+    };
+    enum outcome_t{ PASS, DRIFT, FAIL };
+    virtual ~Monitor(){}
+    virtual const char* get_name() const = 0;
+    virtual cost_t get_cost() const = 0;
+    //verdict stored in the result when check() fails
+    virtual TrackingResult::verdict_t get_verdict() const = 0;
+    virtual outcome_t check(frame_context_t& frame) = 0;
+    //called when the model is (re)initialised
+    virtual void reset(){}
+    //the next frame is judged as if cMo had been the pose of the last accepted frame
+    virtual void seed_pose(const vpHomogeneousMatrix&){}
+  };
+
+  //fails when one of the pose variances goes above a limit
+  class VarLimitMonitor : public Monitor{
+  private:
+    double limit_;
+  public:
+    VarLimitMonitor(double limit);
+    void set_limit(double limit);
+    const char* get_name() const{ return "variance-limit"; }
+    cost_t get_cost() const{ return COST_SCALAR; }
+    TrackingResult::verdict_t get_verdict() const{ return TrackingResult::VARIANCE_LIMIT; }
+    outcome_t check(frame_context_t& frame);
+  };
+
+  //fails when a hinkley test detects a jump in one of the pose variances
+  class HinkleyMonitor : public Monitor{
+  private:
+    boost::array<vpHinkley,6> hink_;
+  public:
+    HinkleyMonitor(double alpha, double delta);
+    //changes the thresholds, the cumulated sums are kept
+    void set_range(double alpha, double delta);
+    const char* get_name() const{ return "hinkley"; }
+    cost_t get_cost() const{ return COST_SCALAR; }
+    TrackingResult::verdict_t get_verdict() const{ return TrackingResult::HINKLEY_JUMP; }
+    outcome_t check(frame_context_t& frame);
+  };
+
+  /*
+   * Upward CUSUM on the sum of the pose variances, normalised by its mean over the first frames after (re)initialisation.
+   * Drifts when the cumulated sum reaches h/2 and fails when it reaches h.
+   */
+  class CusumMonitor : public Monitor{
+  private:
+    static const unsigned int WARMUP = 10;
+    double k_,h_;
+    unsigned int nb_;
+    double reference_;
+    double sum_;
+  public:
+    CusumMonitor(double k, double h);
+    const char* get_name() const{ return "cusum"; }
+    cost_t get_cost() const{ return COST_SCALAR; }
+    TrackingResult::verdict_t get_verdict() const{ return TrackingResult::CUSUM_DRIFT; }
+    outcome_t check(frame_context_t& frame);
+    void reset();
+  };
+
+  /*
+   * Exponentially weighted mean and variance of the sum of the pose variances.
+   * Only reports drift, when the current value leaves the mean by more than width standard deviations.
+   */
+  class EwmaMonitor : public Monitor{
+  private:
+    static const unsigned int WARMUP = 10;
+    double lambda_,width_;
+    unsigned int nb_;
+    double mean_,var_;
+  public:
+    EwmaMonitor(double lambda, double width);
+    const char* get_name() const{ return "ewma"; }
+    cost_t get_cost() const{ return COST_SCALAR; }
+    TrackingResult::verdict_t get_verdict() const{ return TrackingResult::TRACKING_OK; }
+    outcome_t check(frame_context_t& frame);
+    void reset();
+  };
+
+  //fails when the pose moved more than a translation (m) or a rotation (rad) since the last accepted frame
+  class PoseJumpMonitor : public Monitor{
+  private:
+    double max_translation_,max_rotation_;
+    bool has_previous_;
+    vpHomogeneousMatrix previous_;
+  public:
+    PoseJumpMonitor(double max_translation, double max_rotation);
+    const char* get_name() const{ return "pose-jump"; }
+    cost_t get_cost() const{ return COST_POSE; }
+    TrackingResult::verdict_t get_verdict() const{ return TrackingResult::POSE_JUMP; }
+    outcome_t check(frame_context_t& frame);
+    void reset();
+    void seed_pose(const vpHomogeneousMatrix& cMo);
+  };
+
+  /*
+   * Ad-hoc recovery: the median of regions around the middle contour must stay dark.
+   * Medians are stored in the result. When enforce is false the medians are only computed for logging.
+   */
+  class CheckpointMonitor : public Monitor{
+  private:
+    double size_;
+    unsigned int threshold_;
+    bool enforce_;
+    summary_accumulator_t& pixels_;
+  public:
+    CheckpointMonitor(double size, unsigned int threshold, bool enforce, summary_accumulator_t& pixels);
+    void set_size(double size);
+    void set_threshold(unsigned int threshold);
+    const char* get_name() const{ return "checkpoints"; }
+    cost_t get_cost() const{ return COST_IMAGE; }
+    TrackingResult::verdict_t get_verdict() const{ return TrackingResult::CHECKPOINT_FAILED; }
+    outcome_t check(frame_context_t& frame);
+  };
+
+  /*
+   * Runs monitors from the cheapest to the most expensive and stops at the first failure.
+   * COST_IMAGE monitors run every period frames, or on the frame a cheaper monitor reports drift.
+   * Owns the monitors.
+   */
+  class MonitorChain{
+  private:
+    std::vector<Monitor*> monitors_;
+    unsigned int period_;
+    unsigned int since_expensive_;
+    bool expensive_enabled_;
+    bool verbose_;
+    MonitorChain(const MonitorChain&);
+    MonitorChain& operator=(const MonitorChain&);
+  public:
+    MonitorChain();
+    ~MonitorChain();
+    void set_period(unsigned int period);
+    void set_verbose(bool verbose);
+    //when disabled COST_IMAGE monitors never run, even on drift
+    void set_expensive_enabled(bool enabled);
+    //takes ownership of monitor
+    void add(Monitor* monitor);
+    //monitor called name, NULL if there is none
+    Monitor* find(const std::string& name);
+    //when over_budget, COST_IMAGE monitors only run on drift and stay due for the next frame
+    TrackingResult::verdict_t run(frame_context_t& frame, bool over_budget = false);
+    void reset();
+    //see Monitor::seed_pose, the history of the other monitors is kept. Expensive monitors are due on the next frame
+    void seed_pose(const vpHomogeneousMatrix& cMo);
+  };
+}
+#endif /* __MONITORS_H__ */
@@ -0,0 +1,235 @@
+#include "parallel_hybrid.h"
+#include <cmath>
+#include <visp/vpTranslationVector.h>
+#include <visp/vpThetaUVector.h>
+#include <visp/vpTrackingException.h>
+#include "monitors.h"
+
+namespace tracking{
+  const double ParallelHybridTracker::FEEDBACK_TRANSLATION = 0.002;
+  const double ParallelHybridTracker::FEEDBACK_ROTATION = 0.01;
+
+  //weight of a pose component, 0 when its variance is unknown or meaningless
+  static double information(const vpMatrix& covariance, unsigned int i){
+    if(covariance.getRows()<6 || covariance.getCols()<6)
+      return 0.;
+    double variance = covariance[i][i];
+    return variance>0. && variance<HUGE_VAL ? 1./variance : 0.;
+  }
+
+  ParallelHybridTracker:: ParallelHybridTracker() :
+      worker_(NULL),
+      job_(NULL),
+      stop_(false),
+      klt_ok_(false),
+      fused_(0),
+      edge_only_(0),
+      klt_only_(0){
+    worker_ = new boost::thread(&ParallelHybridTracker::run,this);
+  }
+
+  ParallelHybridTracker:: ~ParallelHybridTracker(){
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_one();
+    worker_->join();
+    delete worker_;
+  }
+
+  void ParallelHybridTracker:: run(){
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    for(;;){
+      while(!job_ && !stop_)
+        wake_.wait(lock);
+      if(stop_)
+        break;
+      const vpImage<unsigned char>* I = job_;
+      lock.unlock();
+      bool ok = true;
+      try{
+        klt_.track(*I);
+      }catch(vpException& e){
+        ok = false;
+      }
+      lock.lock();
+      klt_ok_ = ok;
+      job_ = NULL;
+      done_.notify_one();
+    }
+  }
+
+  vpMbEdgeTracker& ParallelHybridTracker:: get_edge_tracker(){
+    return edge_;
+  }
+
+  vpMbKltTracker& ParallelHybridTracker:: get_klt_tracker(){
+    return klt_;
+  }
+
+  void ParallelHybridTracker:: loadConfigFile(const std::string& configFile){
+    loadConfigFile(configFile.c_str());
+  }
+
+  void ParallelHybridTracker:: loadConfigFile(const char* configFile){
+    edge_.loadConfigFile(configFile);
+    klt_.loadConfigFile(configFile);
+    edge_.getCameraParameters(cam);
+  }
+
+  void ParallelHybridTracker:: loadModel(const std::string& modelFile){
+    loadModel(modelFile.c_str());
+  }
+
+  void ParallelHybridTracker:: loadModel(const char* modelFile){
+    edge_.loadModel(modelFile);
+    klt_.loadModel(modelFile);
+  }
+
+  void ParallelHybridTracker:: resetTracker(){
+    edge_.resetTracker();
+    klt_.resetTracker();
+  }
+
+  void ParallelHybridTracker:: init(const vpImage<unsigned char>& I){
+    initFromPose(I,cMo);
+  }
+
+  void ParallelHybridTracker:: initFromPose(const vpImage<unsigned char>& I, const vpHomogeneousMatrix& cMo_){
+    edge_.initFromPose(I,cMo_);
+    klt_.initFromPose(I,cMo_);
+    cMo = cMo_;
+  }
+
+  void ParallelHybridTracker:: setPose(const vpImage<unsigned char>& I, const vpHomogeneousMatrix& cMo_){
+    edge_.setPose(I,cMo_);
+    klt_.setPose(I,cMo_);
+    cMo = cMo_;
+  }
+
+  void ParallelHybridTracker:: setCameraParameters(const vpCameraParameters& camera){
+    cam = camera;
+    edge_.setCameraParameters(camera);
+    klt_.setCameraParameters(camera);
+  }
+
+  void ParallelHybridTracker:: setCovarianceComputation(const bool& flag){
+    computeCovariance = flag;
+    //the weights come from the covariances of both trackers
+    edge_.setCovarianceComputation(true);
+    klt_.setCovarianceComputation(true);
+  }
+
+  void ParallelHybridTracker:: track(const vpImage<unsigned char>& I){
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      job_ = &I;
+    }
+    wake_.notify_one();
+
+    bool edge_ok = true;
+    try{
+      edge_.track(I);
+    }catch(vpException& e){
+      edge_ok = false;
+    }
+    bool klt_ok;
+    {
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      while(job_)
+        done_.wait(lock);
+      klt_ok = klt_ok_;
+    }
+
+    if(!edge_ok && !klt_ok)
+      throw vpTrackingException(vpTrackingException::fatalError,"edge and klt trackers both failed");
+
+    vpHomogeneousMatrix cMo_edge,cMo_klt;
+    edge_.getPose(cMo_edge);
+    klt_.getPose(cMo_klt);
+    vpColVector error_edge = edge_ok ? edge_.getError() : vpColVector(),
+                error_klt = klt_ok ? klt_.getError() : vpColVector();
+    error_.resize(error_edge.getRows()+error_klt.getRows());
+    for(unsigned int i=0;i<error_edge.getRows();i++)
+      error_[i] = error_edge[i];
+    for(unsigned int i=0;i<error_klt.getRows();i++)
+      error_[error_edge.getRows()+i] = error_klt[i];
+
+    if(edge_ok && klt_ok){
+      fuse(cMo_edge,edge_.getCovarianceMatrix(),cMo_klt,klt_.getCovarianceMatrix());
+      fused_++;
+    }else if(edge_ok){
+      cMo = cMo_edge;
+      covarianceMatrix = edge_.getCovarianceMatrix();
+      edge_only_++;
+    }else{
+      cMo = cMo_klt;
+      covarianceMatrix = klt_.getCovarianceMatrix();
+      klt_only_++;
+    }
+
+    feed_back(edge_,I,edge_ok,cMo_edge);
+    feed_back(klt_,I,klt_ok,cMo_klt);
+  }
+
+  void ParallelHybridTracker:: fuse(const vpHomogeneousMatrix& cMo_edge, const vpMatrix& cov_edge, const vpHomogeneousMatrix& cMo_klt, const vpMatrix& cov_klt){
+    //the klt pose as a small motion of the edge pose, each of its components weighted by the information of both trackers
+    vpHomogeneousMatrix motion = cMo_klt*cMo_edge.inverse();
+    vpTranslationVector t;
+    vpThetaUVector tu;
+    motion.extract(t);
+    motion.extract(tu);
+    covarianceMatrix.resize(6,6);
+    for(unsigned int i=0;i<6;i++){
+      double w_edge = information(cov_edge,i),
+             w_klt = information(cov_klt,i);
+      //without covariance both trackers are trusted the same
+      double ratio = w_edge+w_klt>0. ? w_klt/(w_edge+w_klt) : 0.5;
+      if(i<3)
+        t[i] *= ratio;
+      else
+        tu[i-3] *= ratio;
+      covarianceMatrix[i][i] = w_edge+w_klt>0. ? 1./(w_edge+w_klt) : 0.;
+    }
+    cMo = vpHomogeneousMatrix(t,tu)*cMo_edge;
+  }
+
+  void ParallelHybridTracker:: feed_back(vpMbTracker& tracker, const vpImage<unsigned char>& I, bool ok, const vpHomogeneousMatrix& own){
+    if(ok){
+      double translation,rotation;
+      pose_difference(own,cMo,translation,rotation);
+      if(translation<=FEEDBACK_TRANSLATION && rotation<=FEEDBACK_ROTATION)
+        return;
+    }
+    try{
+      tracker.setPose(I,cMo);
+    }catch(vpException& e){
+      //the tracker stays where it was and is fused again on the next frame
+    }
+  }
+
+  vpColVector ParallelHybridTracker:: getError() const{
+    return error_;
+  }
+
+  void ParallelHybridTracker:: display(const vpImage<unsigned char>& I, const vpHomogeneousMatrix& cMo_, const vpCameraParameters& cam_, const vpColor& col, const unsigned int thickness, const bool displayFullModel){
+    edge_.display(I,cMo_,cam_,col,thickness,displayFullModel);
+  }
+
+  void ParallelHybridTracker:: display(const vpImage<vpRGBa>& I, const vpHomogeneousMatrix& cMo_, const vpCameraParameters& cam_, const vpColor& col, const unsigned int thickness, const bool displayFullModel){
+    edge_.display(I,cMo_,cam_,col,thickness,displayFullModel);
+  }
+
+  unsigned long ParallelHybridTracker:: get_fused() const{
+    return fused_;
+  }
+
+  unsigned long ParallelHybridTracker:: get_edge_only() const{
+    return edge_only_;
+  }
+
+  unsigned long ParallelHybridTracker:: get_klt_only() const{
+    return klt_only_;
+  }
+}
@@ -0,0 +1,89 @@
+#ifndef __PARALLEL_HYBRID_H__
+#define __PARALLEL_HYBRID_H__
+#include <string>
+#include <boost/thread.hpp>
+#include <visp/vpImage.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpCameraParameters.h>
+#include <visp/vpColVector.h>
+#include <visp/vpMatrix.h>
+#include <visp/vpColor.h>
+#include <visp/vpMbTracker.h>
+#include <visp/vpMbEdgeTracker.h>
+#include <visp/vpMbKltTracker.h>
+
+namespace tracking{
+  /*
+   * Hybrid tracker running a moving edge tracker and a klt tracker side by side instead of solving them jointly
+   * like vpMbEdgeKltTracker: the klt tracker tracks on a worker thread while the edge tracker tracks on the calling one.
+   * Both poses are fused by inverse variance weighting of each pose component, and a tracker that failed or
+   * moved away from the fused pose starts the next frame from it. When one tracker fails, the other one gives the pose.
+   * Both trackers load the same config and model files.
+   */
+  class ParallelHybridTracker : public vpMbTracker{
+  private:
+    //a tracker further than this from the fused pose is moved to it for the next frame
+    static const double FEEDBACK_TRANSLATION; //m
+    static const double FEEDBACK_ROTATION;    //rad
+
+    vpMbEdgeTracker edge_;
+    vpMbKltTracker klt_;
+    vpColVector error_;
+
+    //klt worker
+    boost::thread* worker_;
+    boost::mutex mutex_;
+    boost::condition_variable wake_,done_;
+    const vpImage<unsigned char>* job_; //frame the worker tracks, NULL when idle
+    bool stop_;
+    bool klt_ok_;
+
+    unsigned long fused_,edge_only_,klt_only_;
+    ParallelHybridTracker(const ParallelHybridTracker&);
+    ParallelHybridTracker& operator=(const ParallelHybridTracker&);
+    void run();
+    //combines the poses and covariances of both trackers into cMo and covarianceMatrix
+    void fuse(const vpHomogeneousMatrix& cMo_edge, const vpMatrix& cov_edge, const vpHomogeneousMatrix& cMo_klt, const vpMatrix& cov_klt);
+    void feed_back(vpMbTracker& tracker, const vpImage<unsigned char>& I, bool ok, const vpHomogeneousMatrix& own);
+
+  protected:
+    //the model is loaded by both trackers, there are no faces of our own
+    void initFaceFromCorners(vpMbtPolygon&){}
+    void initFaceFromLines(vpMbtPolygon&){}
+    void initCylinder(const vpPoint&, const vpPoint&, const double, const unsigned int = 0){}
+    void initCircle(const vpPoint&, const vpPoint&, const vpPoint&, const double, const unsigned int = 0){}
+
+  public:
+    ParallelHybridTracker();
+    ~ParallelHybridTracker();
+
+    //the trackers being fused, to configure or inspect their features
+    vpMbEdgeTracker& get_edge_tracker();
+    vpMbKltTracker& get_klt_tracker();
+
+    //vpMbTracker
+    void loadConfigFile(const std::string& configFile);
+    void loadConfigFile(const char* configFile);
+    void loadModel(const std::string& modelFile);
+    void loadModel(const char* modelFile);
+    void resetTracker();
+    void init(const vpImage<unsigned char>& I);
+    void initFromPose(const vpImage<unsigned char>& I, const vpHomogeneousMatrix& cMo_);
+    void setPose(const vpImage<unsigned char>& I, const vpHomogeneousMatrix& cMo_);
+    void setCameraParameters(const vpCameraParameters& camera);
+    void setCovarianceComputation(const bool& flag);
+    //throws vpTrackingException when both trackers fail
+    void track(const vpImage<unsigned char>& I);
+    void testTracking(){}
+    //residuals of the trackers that succeeded on the last frame, edges first
+    vpColVector getError() const;
+    void display(const vpImage<unsigned char>& I, const vpHomogeneousMatrix& cMo_, const vpCameraParameters& cam_, const vpColor& col, const unsigned int thickness = 1, const bool displayFullModel = false);
+    void display(const vpImage<vpRGBa>& I, const vpHomogeneousMatrix& cMo_, const vpCameraParameters& cam_, const vpColor& col, const unsigned int thickness = 1, const bool displayFullModel = false);
+
+    //metrics: frames where both poses were fused, and where only one tracker succeeded
+    unsigned long get_fused() const;
+    unsigned long get_edge_only() const;
+    unsigned long get_klt_only() const;
+  };
+}
+#endif /* __PARALLEL_HYBRID_H__ */
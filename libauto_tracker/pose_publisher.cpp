@@ -0,0 +1,89 @@
+#include "pose_publisher.h"
+
+namespace tracking{
+  PoseSubscriber:: PoseSubscriber(unsigned int capacity) :
+      queue_(capacity),
+      active_(true),
+      dropped_(0),
+      next_retired_(NULL){
+  }
+
+  bool PoseSubscriber:: pop(pose_record_t& record){
+    return queue_.pop(record);
+  }
+
+  bool PoseSubscriber:: latest(pose_record_t& record){
+    bool got = false;
+    while(queue_.pop(record))
+      got = true;
+    return got;
+  }
+
+  unsigned long PoseSubscriber:: get_dropped() const{
+    return dropped_.load(boost::memory_order_relaxed);
+  }
+
+  void PoseSubscriber:: unsubscribe(){
+    active_.store(false,boost::memory_order_release);
+  }
+
+  PosePublisher:: PosePublisher(){
+    for(unsigned int i=0;i<MAX_SUBSCRIBERS;i++)
+      subscribers_[i].store(NULL);
+    retired_.store(NULL);
+  }
+
+  PosePublisher:: ~PosePublisher(){
+    for(unsigned int i=0;i<MAX_SUBSCRIBERS;i++)
+      delete subscribers_[i].load();
+    free_list(retired_.load());
+  }
+
+  void PosePublisher:: free_list(PoseSubscriber* subscriber){
+    while(subscriber){
+      PoseSubscriber* next = subscriber->next_retired_;
+      delete subscriber;
+      subscriber = next;
+    }
+  }
+
+  PoseSubscriber* PosePublisher:: subscribe(unsigned int capacity){
+    //subscribe allocates anyway, it frees what publish retired
+    free_list(retired_.exchange(NULL,boost::memory_order_acquire));
+    PoseSubscriber* subscriber = new PoseSubscriber(capacity);
+    for(unsigned int i=0;i<MAX_SUBSCRIBERS;i++){
+      PoseSubscriber* expected = NULL;
+      if(subscribers_[i].compare_exchange_strong(expected,subscriber,boost::memory_order_acq_rel))
+        return subscriber;
+    }
+    delete subscriber;
+    return NULL;
+  }
+
+  void PosePublisher:: publish(const pose_record_t& record){
+    for(unsigned int i=0;i<MAX_SUBSCRIBERS;i++){
+      PoseSubscriber* subscriber = subscribers_[i].load(boost::memory_order_acquire);
+      if(subscriber == NULL)
+        continue;
+      if(!subscriber->active_.load(boost::memory_order_acquire)){
+        //only this thread empties slots, the exchange cannot race with another removal.
+        //Freeing could block on the allocator, the subscriber is pushed on the retired list instead
+        if(subscribers_[i].compare_exchange_strong(subscriber,NULL,boost::memory_order_acq_rel)){
+          PoseSubscriber* head = retired_.load(boost::memory_order_relaxed);
+          do
+            subscriber->next_retired_ = head;
+          while(!retired_.compare_exchange_weak(head,subscriber,boost::memory_order_release,boost::memory_order_relaxed));
+        }
+        continue;
+      }
+      if(!subscriber->queue_.push(record))
+        subscriber->dropped_.fetch_add(1,boost::memory_order_relaxed);
+    }
+  }
+
+  void PosePublisher:: fill(pose_record_t& record, const vpHomogeneousMatrix& cMo){
+    for(unsigned int i=0;i<4;i++)
+      for(unsigned int j=0;j<4;j++)
+        record.cMo[i*4+j] = cMo[i][j];
+  }
+}
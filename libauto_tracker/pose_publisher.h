@@ -0,0 +1,73 @@
+#ifndef __POSE_PUBLISHER_H__
+#define __POSE_PUBLISHER_H__
+#include <boost/array.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <visp/vpHomogeneousMatrix.h>
+
+namespace tracking{
+  //state of the tracker when a pose record was produced
+  enum tracker_state_t{
+    STATE_DETECT_FLASHCODE,
+    STATE_REDETECT_FLASHCODE,
+    STATE_DETECT_MODEL,
+    STATE_TRACK_MODEL
+  };
+
+  //plain copyable pose record, one per processed frame
+  struct pose_record_t{
+    int frame;
+    double timestamp; //in ms, see input_ready
+    boost::array<double,16> cMo; //row-major homogeneous matrix
+    boost::array<double,6> covariance; //diagonal of the pose covariance matrix
+    tracker_state_t state;
+    bool valid; //false when the tracker has no usable pose for this frame
+    bool skipped; //the frame was dropped by the qos controller, the pose is the previous one
+  };
+
+  /*
+   * Consumer end of a single-producer single-consumer ring.
+   * Only one thread may pop from a given subscriber.
+   */
+  class PoseSubscriber{
+  private:
+    boost::lockfree::spsc_queue<pose_record_t> queue_;
+    boost::atomic<bool> active_;
+    boost::atomic<unsigned long> dropped_;
+    PoseSubscriber* next_retired_;
+    friend class PosePublisher;
+    PoseSubscriber(unsigned int capacity);
+  public:
+    //pops the oldest record, returns false if the ring is empty
+    bool pop(pose_record_t& record);
+    //drains the ring and keeps the most recent record, returns false if the ring was empty
+    bool latest(pose_record_t& record);
+    //records lost because the consumer did not keep up
+    unsigned long get_dropped() const;
+    //stops delivery. The subscriber is freed by a later subscribe() and must not be used afterwards
+    void unsubscribe();
+  };
+
+  /*
+   * Delivers pose records to registered subscribers.
+   * publish() never blocks nor allocates: when a subscriber's ring is full the record is dropped for that subscriber.
+   * It takes unsubscribed subscribers out of their slots and retires them, subscribe() frees them.
+   */
+  class PosePublisher{
+  public:
+    static const unsigned int MAX_SUBSCRIBERS = 8;
+  private:
+    boost::atomic<PoseSubscriber*> subscribers_[MAX_SUBSCRIBERS];
+    boost::atomic<PoseSubscriber*> retired_; //pushed by publish(), taken as a whole by subscribe()
+    static void free_list(PoseSubscriber* subscriber);
+  public:
+    PosePublisher();
+    ~PosePublisher();
+    //registers a new consumer with a ring of the given capacity, returns NULL if all slots are taken
+    PoseSubscriber* subscribe(unsigned int capacity = 64);
+    void publish(const pose_record_t& record);
+    //fills the pose part of a record
+    static void fill(pose_record_t& record, const vpHomogeneousMatrix& cMo);
+  };
+}
+#endif /* __POSE_PUBLISHER_H__ */
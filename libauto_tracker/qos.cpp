@@ -0,0 +1,105 @@
+#include "qos.h"
+#include <algorithm>
+
+namespace tracking{
+  const double QosController::RECOVER_RATIO = 0.7;
+  const double QosController::SMOOTHING = 0.3;
+  const double QosController::MAX_DEBT = 4.;
+
+  QosController:: QosController(double period) :
+      period_(period),
+      level_(QOS_FULL),
+      has_cost_(false),
+      cost_(0.),
+      debt_(0.),
+      over_(0),
+      under_(0),
+      skipped_(0),
+      changes_(0){
+    for(unsigned int i=0;i<QOS_NB_LEVELS;i++)
+      frames_[i] = 0;
+  }
+
+  bool QosController:: enabled() const{
+    return period_>0.;
+  }
+
+  double QosController:: get_period() const{
+    return period_;
+  }
+
+  QosController::level_t QosController:: get_level() const{
+    return level_;
+  }
+
+  void QosController:: change_level(level_t level){
+    level_ = level;
+    changes_++;
+    over_ = under_ = 0;
+    //the cost of the new level is unknown, restart smoothing from the next frame
+    has_cost_ = false;
+    if(level_!=QOS_SKIP_FRAMES)
+      debt_ = 0.;
+  }
+
+  void QosController:: end_frame(double cost){
+    frames_[level_]++;
+    if(!enabled())
+      return;
+    cost_ = has_cost_ ? cost_ + SMOOTHING*(cost-cost_) : cost;
+    has_cost_ = true;
+    debt_ = std::min(std::max(0.,debt_ + cost - period_),MAX_DEBT*period_);
+
+    if(cost_>period_){
+      over_++;
+      under_ = 0;
+    }else if(cost_<RECOVER_RATIO*period_){
+      under_++;
+      over_ = 0;
+    }else
+      over_ = under_ = 0;
+
+    if(over_>=DEGRADE_FRAMES && level_<QOS_SKIP_FRAMES)
+      change_level((level_t)(level_+1));
+    else if(under_>=RECOVER_FRAMES && level_>QOS_FULL)
+      change_level((level_t)(level_-1));
+  }
+
+  bool QosController:: skip_frame(){
+    if(level_!=QOS_SKIP_FRAMES || debt_<period_)
+      return false;
+    //a dropped frame costs nothing and pays back one period of lateness
+    debt_ -= period_;
+    skipped_++;
+    return true;
+  }
+
+  unsigned int QosController:: get_frames(level_t level) const{
+    return frames_[level];
+  }
+
+  unsigned int QosController:: get_skipped() const{
+    return skipped_;
+  }
+
+  unsigned int QosController:: get_changes() const{
+    return changes_;
+  }
+
+  const char* QosController:: get_level_name(level_t level){
+    switch(level){
+      case QOS_FULL:
+        return "full";
+      case QOS_SKIP_CHECKPOINTS:
+        return "skip checkpoints";
+      case QOS_SPARSE_EDGES:
+        return "sparse edges";
+      case QOS_DECIMATED:
+        return "decimated";
+      case QOS_SKIP_FRAMES:
+        return "skip frames";
+      default:
+        return "unknown";
+    }
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef __QOS_H__
+#define __QOS_H__
+
+namespace tracking{
+  /*
+   * Keeps the tracking cost under a target frame period by stepping through degradation levels.
+   * The cost of each tracked frame is smoothed; the level goes one step down after a few frames over the period
+   * and one step back up after a longer run of frames with enough headroom.
+   * At the last level whole frames are dropped until the accumulated lateness is paid back.
+   */
+  class QosController{
+  public:
+    enum level_t{
+      QOS_FULL,              //everything runs
+      QOS_SKIP_CHECKPOINTS,  //image based monitors are not run
+      QOS_SPARSE_EDGES,      //moving edges are sampled twice as sparsely
+      QOS_DECIMATED,         //tracking runs on an image decimated twice more than --mbt-decimation
+      QOS_SKIP_FRAMES,       //frames are dropped to catch up
+      QOS_NB_LEVELS
+    };
+  private:
+    static const unsigned int DEGRADE_FRAMES = 3;   //consecutive frames over the period before degrading
+    static const unsigned int RECOVER_FRAMES = 25;  //consecutive frames with headroom before recovering
+    static const double RECOVER_RATIO;              //headroom: smoothed cost below this fraction of the period
+    static const double SMOOTHING;                  //weight of the last frame in the smoothed cost
+    static const double MAX_DEBT;                   //lateness is capped to this many periods
+
+    double period_;
+    level_t level_;
+    bool has_cost_;
+    double cost_;
+    double debt_;
+    unsigned int over_,under_;
+    unsigned int frames_[QOS_NB_LEVELS];
+    unsigned int skipped_;
+    unsigned int changes_;
+    void change_level(level_t level);
+  public:
+    //period in ms, 0 disables the controller
+    QosController(double period = 0.);
+    bool enabled() const;
+    double get_period() const;
+    level_t get_level() const;
+    //accounts the processing time (ms) of one frame, may change the level
+    void end_frame(double cost);
+    //true when the current frame should be dropped, only at QOS_SKIP_FRAMES
+    bool skip_frame();
+
+    //metrics
+    unsigned int get_frames(level_t level) const;
+    unsigned int get_skipped() const;
+    unsigned int get_changes() const;
+    static const char* get_level_name(level_t level);
+  };
+}
+#endif /* __QOS_H__ */
@@ -0,0 +1,40 @@
+#include "ros_export.h"
+#include "tracking.h"
+
+namespace tracking{
+  void
+  RosFeatureExport::updateMovingEdgeSites(Tracker_& tracker, visp_tracker::MovingEdgeSitesPtr sites)
+  {
+    if (!sites)
+      return;
+
+    tracker.exportMovingEdgeSites(sites_);
+    sites->moving_edge_sites.reserve(sites->moving_edge_sites.size() + sites_.size());
+    for (unsigned int i = 0; i < sites_.size(); i++)
+    {
+      visp_tracker::MovingEdgeSite movingEdgeSite;
+      movingEdgeSite.x = sites_.x[i];
+      movingEdgeSite.y = sites_.y[i];
+      movingEdgeSite.suppress = sites_.suppress[i];
+      sites->moving_edge_sites.push_back (movingEdgeSite);
+    }
+  }
+
+  void
+  RosFeatureExport::updateKltPoints(Tracker_& tracker, visp_tracker::KltPointsPtr klt)
+  {
+    if (!klt)
+      return;
+
+    tracker.exportKltPoints(klt_);
+    klt->klt_points_positions.reserve(klt->klt_points_positions.size() + klt_.size());
+    for (unsigned int i = 0; i < klt_.size(); i++)
+    {
+      visp_tracker::KltPoint kltPoint;
+      kltPoint.id = klt_.id[i];
+      kltPoint.i = klt_.i[i];
+      kltPoint.j = klt_.j[i];
+      klt->klt_points_positions.push_back (kltPoint);
+    }
+  }
+}
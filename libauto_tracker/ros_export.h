@@ -0,0 +1,24 @@
+#ifndef __ROS_EXPORT_H__
+#define __ROS_EXPORT_H__
+#include "visp_tracker/MovingEdgeSites.h"
+#include "visp_tracker/KltPoints.h"
+#include "feature_export.h"
+
+namespace tracking{
+  class Tracker_;
+
+  /*
+   * Converts the tracker features into visp_tracker messages.
+   * Kept apart from the tracker so that only ROS nodes depend on the message types.
+   */
+  class RosFeatureExport{
+  private:
+    moving_edge_sites_t sites_;
+    klt_points_t klt_;
+  public:
+    //appends the current features of the tracker to the message
+    void updateMovingEdgeSites(Tracker_& tracker, visp_tracker::MovingEdgeSitesPtr sites);
+    void updateKltPoints(Tracker_& tracker, visp_tracker::KltPointsPtr klt);
+  };
+}
+#endif /* __ROS_EXPORT_H__ */
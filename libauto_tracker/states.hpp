@@ -16,6 +16,12 @@
 #include <fstream>
 #include <boost/thread.hpp>
 #include "events.h"
+#include "model_points.h"
+#include "tracking_result.h"
+#include "qos.h"
+#include "frame_budget.h"
+#include "display_thread.h"
+#include "parallel_hybrid.h"
 
 
 namespace msm = boost::msm;
@@ -24,13 +30,14 @@ namespace tracking{
   struct WaitingForInput : public msm::front::state<>{
       template <class Event, class Fsm>
       void on_entry(Event const&, Fsm& fsm){
-        if(fsm.get_cmd().get_verbose())
+        if(fsm.get_settings().verbose)
           std::cout <<"entering: WaitingForInput" << std::endl;
       }
       template <class Event, class Fsm>
       void on_exit(Event const& evt, Fsm& fsm){
-        if(fsm.get_cmd().get_verbose())
+        if(fsm.get_settings().verbose)
           std::cout <<"leaving: WaitingForInput" << std::endl;
+        fsm.post_display(evt.I,STATE_DETECT_FLASHCODE);
         if(fsm.get_flush_display()){
           vpDisplay::display(evt.I);
           vpDisplay::flush(evt.I);
@@ -42,7 +49,7 @@ namespace tracking{
   struct Finished : public msm::front::state<>{
     template <class Event, class Fsm>
     void on_entry(Event const& evt, Fsm& fsm){
-      if(fsm.get_cmd().get_verbose())
+      if(fsm.get_settings().verbose)
       {
         typename Fsm::statistics_t& statistics = fsm.get_statistics();
         std::cout << "statistics:" << std::endl;
@@ -80,6 +87,46 @@ namespace tracking{
         std::cout << "\t\tmedian:" << boost::accumulators::median(statistics.var_wz) << std::endl;
         std::cout << "\t\tmean:" << boost::accumulators::mean(statistics.var_wz) << std::endl;
         std::cout << "\t\tmax:" << boost::accumulators::max(statistics.var_wz) << std::endl;
+
+        std::cout << "\tconvergence steps:" << std::endl;
+        std::cout << "\t\tmedian:" << boost::accumulators::median(statistics.convergence_steps) << std::endl;
+        std::cout << "\t\tmean:" << boost::accumulators::mean(statistics.convergence_steps) << std::endl;
+        std::cout << "\t\tmax:" << boost::accumulators::max(statistics.convergence_steps) << std::endl;
+
+        const QosController& qos = fsm.get_qos();
+        if(qos.enabled()){
+          std::cout << "\tqos (period " << qos.get_period() << "ms, " << qos.get_changes() << " level changes):" << std::endl;
+          for(unsigned int i=0;i<QosController::QOS_NB_LEVELS;i++)
+            std::cout << "\t\t" << QosController::get_level_name((QosController::level_t)i) << ":" << qos.get_frames((QosController::level_t)i) << " frames" << std::endl;
+          std::cout << "\t\tskipped:" << qos.get_skipped() << " frames" << std::endl;
+        }
+
+        if(fsm.get_settings().fast_recovery_steps>0)
+          std::cout << "\tfast recoveries:" << fsm.get_fast_recoveries() << "/" << fsm.get_recovery_attempts() << " attempts" << std::endl;
+
+        if(fsm.get_settings().klt_warm_restart>0)
+          std::cout << "\tklt warm restarts:" << fsm.get_warm_restarts() << std::endl;
+
+        const ParallelHybridTracker* parallel = dynamic_cast<const ParallelHybridTracker*>(&fsm.get_mbt());
+        if(parallel)
+          std::cout << "\tparallel hybrid:" << parallel->get_fused() << " fused, " << parallel->get_edge_only() << " edges only, " << parallel->get_klt_only() << " klt only" << std::endl;
+
+        if(fsm.get_reconfigurations()>0)
+          std::cout << "\treconfigurations:" << fsm.get_reconfigurations() << std::endl;
+
+        if(fsm.get_settings().mbt_decimation>1)
+          std::cout << "\tfull resolution refinements:" << fsm.get_refinements() << std::endl;
+
+        const FrameBudget& budget = fsm.get_frame_budget();
+        if(budget.enabled()){
+          std::cout << "\tframe budget (" << budget.get_budget() << "ms, " << budget.get_overruns() << "/" << budget.get_frames() << " frames over):" << std::endl;
+          for(unsigned int i=0;i<FrameBudget::NB_STAGES;i++)
+            std::cout << "\t\t" << FrameBudget::get_stage_name((FrameBudget::stage_t)i) << ":" << budget.get_mean_time((FrameBudget::stage_t)i) << "ms per frame" << std::endl;
+        }
+
+        const DisplayThread* display = fsm.get_display_thread();
+        if(display)
+          std::cout << "\tasync display: " << display->get_rendered() << " rendered, " << display->get_dropped() << " dropped out of " << display->get_submitted() << " submitted" << std::endl;
       }
     }
   };
@@ -91,6 +138,7 @@ namespace tracking{
       vpImagePoint corner2;
       vpImagePoint corner3;
       virtual vpColor getColor() = 0;
+      virtual tracker_state_t getState() = 0;
       template <class Fsm>
       void on_entry(finished const& evt, Fsm& fsm){}
 
@@ -100,18 +148,19 @@ namespace tracking{
       template <class Event, class Fsm>
       void on_entry(Event const&, Fsm& fsm)
       {
-        if(fsm.get_cmd().get_verbose())
+        if(fsm.get_settings().verbose)
           std::cout <<"entering: DetectFlashcode" << std::endl;
       }
       template <class Event, class Fsm>
       void on_exit(Event const& evt, Fsm& fsm)
       {
-        if(fsm.get_cmd().get_verbose())
+        if(fsm.get_settings().verbose)
           std::cout <<"leaving: DetectFlashcode" << std::endl;
+        fsm.post_display(evt.I,getState());
         if(fsm.get_flush_display()) {
           vpDisplay::display(evt.I);
         }
-        std::vector<cv::Point>& polygon = fsm.get_detector().get_polygon();
+        const detectors::polygon_t& polygon = fsm.get_detector().get_polygon();
         if(polygon.size()!=4) {
           if(fsm.get_flush_display()) vpDisplay::flush(evt.I);
           return;
@@ -130,8 +179,8 @@ namespace tracking{
             return;
           }
 
-          std::vector<std::pair<cv::Point,cv::Point> >& lines = fsm.get_detector().get_lines();
-          for(std::vector<std::pair<cv::Point,cv::Point> >::iterator i = lines.begin();
+          const detectors::lines_t& lines = fsm.get_detector().get_lines();
+          for(detectors::lines_t::const_iterator i = lines.begin();
               i!=lines.end();
               i++
           ){
@@ -149,15 +198,17 @@ namespace tracking{
 
   struct DetectFlashcode: public DetectFlashcodeGeneric {
     vpColor getColor(){ return vpColor::green; }
+    tracker_state_t getState(){ return STATE_DETECT_FLASHCODE; }
   };
   struct ReDetectFlashcode: public DetectFlashcodeGeneric {
     template <class Event, class Fsm>
     void on_entry(Event const&, Fsm& fsm)
     {
-      if(fsm.get_cmd().get_verbose())
+      if(fsm.get_settings().verbose)
         std::cout <<"entering: ReDetectFlashcode" << std::endl;
     }
     vpColor getColor(){ return vpColor::orange; }
+    tracker_state_t getState(){ return STATE_REDETECT_FLASHCODE; }
   };
 
   struct DetectModel : public msm::front::state<>
@@ -176,23 +227,24 @@ namespace tracking{
       template <class Event, class Fsm>
       void on_entry(Event const&, Fsm& fsm)
       {
-        if(fsm.get_cmd().get_verbose())
+        if(fsm.get_settings().verbose)
           std::cout <<"entering: DetectModel" << std::endl;
       }
       template <class Event, class Fsm>
       void on_exit(Event const& evt, Fsm& fsm)
       {
-        if(fsm.get_cmd().get_verbose())
+        if(fsm.get_settings().verbose)
           std::cout <<"leaving: DetectModel" << std::endl;
-        std::vector<vpPoint>& points3D_inner = fsm.get_points3D_inner();
-        std::vector<vpPoint>& points3D_outer = fsm.get_points3D_outer();
+        //contours as projected by the tracker when the model was detected
+        const ModelPoints& model_points = fsm.get_model_points();
 
-        fsm.get_mbt().getPose(cMo);
+        cMo = fsm.get_tracking_result().cMo;
 
         for(unsigned int i=0;i<4;i++){
-          vpMeterPixelConversion::convertPoint(fsm.get_cam(),points3D_outer[i].get_x(),points3D_outer[i].get_y(),model_outer_corner[i]);
-          vpMeterPixelConversion::convertPoint(fsm.get_cam(),points3D_inner[i].get_x(),points3D_inner[i].get_y(),model_inner_corner[i]);
+          model_outer_corner[i] = model_points.get_image_point(ModelPoints::OUTER,i);
+          model_inner_corner[i] = model_points.get_image_point(ModelPoints::INNER,i);
         }
+        fsm.post_display(fsm.get_I(),STATE_DETECT_MODEL);
         if(fsm.get_flush_display()){
           vpImage<vpRGBa>& I = fsm.get_I();
           vpDisplay::displayCharString(I,model_inner_corner[0],"mi1",vpColor::blue);
@@ -243,7 +295,7 @@ namespace tracking{
 
     template <class Fsm>
     void on_entry(finished const& evt, Fsm& fsm){
-      fsm.get_mbt().getPose(cMo);
+      cMo = fsm.get_tracking_result().cMo;
     }
 
     template <class Fsm>
@@ -252,7 +304,7 @@ namespace tracking{
     template <class Event, class Fsm>
     void on_entry(Event const& evt, Fsm& fsm)
     {
-      if(fsm.get_cmd().show_plot() && plot_ == NULL){
+      if(fsm.get_settings().show_plot && !fsm.get_display_thread() && plot_ == NULL){
         plot_ = new vpPlot(1, 700, 700, 100, 200, "Variances");
         plot_->initGraph(0,7);
       }
@@ -260,21 +312,22 @@ namespace tracking{
     template <class Event, class Fsm>
     void on_exit(Event const& evt, Fsm& fsm)
     {
-      fsm.get_mbt().getPose(cMo);
+      const TrackingResult& result = fsm.get_tracking_result();
+      cMo = result.cMo;
+      fsm.post_display(evt.I,STATE_TRACK_MODEL);
       if(fsm.get_flush_display()){
         vpDisplay::display(evt.I);
         fsm.get_mbt().display(evt.I, cMo, fsm.get_cam(), vpColor::red, 1);// display the model at the computed pose.
         vpDisplay::displayFrame(evt.I,cMo,fsm.get_cam(),.1,vpColor::none,2);
-        if(fsm.get_cmd().using_adhoc_recovery() && fsm.get_cmd().get_adhoc_recovery_display()){
-          for(unsigned int p=0;p<fsm.get_points3D_middle().size();p++){
-            vpPoint& point3D = fsm.get_points3D_middle()[p];
-            vpPoint& point3D_inner = fsm.get_points3D_inner()[p];
-            double _u=0.,_v=0.,_u_inner=0.,_v_inner=0.;
-
-            vpMeterPixelConversion::convertPoint(fsm.get_cam(),point3D.get_x(),point3D.get_y(),_u,_v);
-            vpMeterPixelConversion::convertPoint(fsm.get_cam(),point3D_inner.get_x(),point3D_inner.get_y(),_u_inner,_v_inner);
-            int region_width= std::max((int)(std::abs(_u-_u_inner)*fsm.get_cmd().get_adhoc_recovery_size()),1);
-            int region_height=std::max((int)(std::abs(_v-_v_inner)*fsm.get_cmd().get_adhoc_recovery_size()),1);
+        if(fsm.get_settings().using_adhoc_recovery && fsm.get_settings().adhoc_recovery_display){
+          const ModelPoints& model_points = fsm.get_model_points();
+          for(unsigned int p=0;p<model_points.size(ModelPoints::MIDDLE);p++){
+            double _u = model_points.get_u(ModelPoints::MIDDLE,p),
+                   _v = model_points.get_v(ModelPoints::MIDDLE,p),
+                   _u_inner = model_points.get_u(ModelPoints::INNER,p),
+                   _v_inner = model_points.get_v(ModelPoints::INNER,p);
+            int region_width= std::max((int)(std::abs(_u-_u_inner)*fsm.get_settings().adhoc_recovery_size),1);
+            int region_height=std::max((int)(std::abs(_v-_v_inner)*fsm.get_settings().adhoc_recovery_size),1);
 
             int u=(int)_u;
             int v=(int)_v;
@@ -295,12 +348,11 @@ namespace tracking{
         }
         vpDisplay::flush(evt.I);
 
-        vpMatrix mat = fsm.get_mbt().getCovarianceMatrix();
-        if(fsm.get_cmd().show_plot()){
-          if(fsm.get_cmd().using_var_limit())
-            plot_->plot(0,6,iter_,(double)fsm.get_cmd().get_var_limit());
+        if(fsm.get_settings().show_plot){
+          if(fsm.get_settings().using_var_limit)
+            plot_->plot(0,6,iter_,(double)fsm.get_settings().var_limit);
           for(unsigned int i=0;i<6;i++)
-            plot_->plot(0,i,iter_,mat[i][i]);
+            plot_->plot(0,i,iter_,result.covariance[i]);
         }
       }
 
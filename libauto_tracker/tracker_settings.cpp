@@ -0,0 +1,46 @@
+#include "tracker_settings.h"
+#include <algorithm>
+
+namespace tracking{
+  tracker_settings_t:: tracker_settings_t(CmdLine& cmd) :
+      tracker_type(cmd.get_tracker_type()),
+      verbose(cmd.get_verbose()),
+      xml_file(cmd.get_xml_file()),
+      wrl_file(cmd.get_wrl_file()),
+      dmx_timeout(cmd.get_dmx_timeout()),
+      mbt_convergence_steps(cmd.get_mbt_convergence_steps()),
+      using_convergence_threshold(cmd.using_convergence_threshold()),
+      convergence_translation(0.),
+      convergence_rotation(0.),
+      using_convergence_residual(cmd.using_convergence_residual()),
+      convergence_residual(cmd.get_convergence_residual()),
+      mbt_decimation(std::max(cmd.get_mbt_decimation(),1u)),
+      using_refine_variance(cmd.using_refine_variance()),
+      refine_variance(cmd.get_refine_variance()),
+      using_roi_margin(cmd.using_roi_margin()),
+      roi_margin(cmd.get_roi_margin()),
+      using_mbt_dynamic_range(cmd.using_mbt_dynamic_range()),
+      mbt_dynamic_range(cmd.get_mbt_dynamic_range()),
+      fast_recovery_steps(cmd.get_fast_recovery_steps()),
+      klt_warm_restart(cmd.get_klt_warm_restart()),
+      using_adhoc_recovery(cmd.using_adhoc_recovery()),
+      adhoc_recovery_size(cmd.get_adhoc_recovery_size()),
+      adhoc_recovery_ratio(cmd.get_adhoc_recovery_ratio()),
+      adhoc_recovery_display(cmd.get_adhoc_recovery_display()),
+      using_var_file(cmd.using_var_file()),
+      log_pose(cmd.log_pose()),
+      log_checkpoints(cmd.log_checkpoints()),
+      show_plot(cmd.show_plot()),
+      using_var_limit(cmd.using_var_limit()),
+      var_limit(cmd.get_var_limit()){
+    //these getters throw when the option is not given
+    if(using_convergence_threshold){
+      convergence_translation = cmd.get_convergence_translation();
+      convergence_rotation = cmd.get_convergence_rotation();
+    }
+  }
+
+  bool tracker_settings_t:: using_checkpoints() const{
+    return using_adhoc_recovery || log_checkpoints;
+  }
+}
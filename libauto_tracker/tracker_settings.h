@@ -0,0 +1,58 @@
+#ifndef __TRACKER_SETTINGS_H__
+#define __TRACKER_SETTINGS_H__
+#include <string>
+#include "cmd_line/cmd_line.h"
+
+namespace tracking{
+  /*
+   * Options read by the tracker on every frame, looked up once in the command line when the tracker is built.
+   * Options of CmdLine are behind program_options lookups (vm_.count, tracker-type string), these are plain fields.
+   * Values of optional options are only meaningful when their using_ flag is set.
+   * Tuning options may then be changed between frames, see Tracker_::reconfigure.
+   */
+  struct tracker_settings_t{
+    CmdLine::TRACKER_TYPE tracker_type;
+    bool verbose;
+    std::string xml_file;
+    std::string wrl_file;
+    int dmx_timeout;
+
+    //convergence
+    int mbt_convergence_steps;
+    bool using_convergence_threshold;
+    double convergence_translation;
+    double convergence_rotation;
+    bool using_convergence_residual;
+    double convergence_residual;
+
+    //resolution and search regions
+    unsigned int mbt_decimation;      //at least 1
+    bool using_refine_variance;
+    double refine_variance;
+    bool using_roi_margin;
+    int roi_margin;
+    bool using_mbt_dynamic_range;
+    double mbt_dynamic_range;
+
+    //recovery
+    unsigned int fast_recovery_steps;
+    unsigned int klt_warm_restart;
+    bool using_adhoc_recovery;
+    double adhoc_recovery_size;
+    double adhoc_recovery_ratio;
+    bool adhoc_recovery_display;
+
+    //logging and display
+    bool using_var_file;
+    bool log_pose;
+    bool log_checkpoints;
+    bool show_plot;
+    bool using_var_limit;
+    double var_limit;
+
+    tracker_settings_t(CmdLine& cmd);
+    //checkpoints are projected and read for the ad-hoc recovery or to log them
+    bool using_checkpoints() const;
+  };
+}
+#endif /* __TRACKER_SETTINGS_H__ */
@@ -1,8 +1,7 @@
-#include "ros/ros.h"
 #include "cv.h"
 #include "highgui.h"
 #include "tracking.h"
-#include <visp/vpImageConvert.h>
+#include "imgconv/convert.h"
 #include <visp/vpPixelMeterConversion.h>
 #include <visp/vpImagePoint.h>
 #include <visp/vpDisplayX.h>
@@ -15,17 +14,63 @@
 #include <visp/vpMbEdgeTracker.h>
 
 #include "logfilewriter.hpp"
+#include "parallel_hybrid.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
 
 namespace tracking{
+  //camera parameters matching an image subsampled by factor
+  static vpCameraParameters decimated_camera(const vpCameraParameters& cam, unsigned int factor){
+    vpCameraParameters decimated;
+    double f = (double)factor;
+    if(cam.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion)
+      decimated.initPersProjWithDistortion(cam.get_px()/f,cam.get_py()/f,cam.get_u0()/f,cam.get_v0()/f,cam.get_kud(),cam.get_kdu());
+    else
+      decimated.initPersProjWithoutDistortion(cam.get_px()/f,cam.get_py()/f,cam.get_u0()/f,cam.get_v0()/f);
+    return decimated;
+  }
 
   Tracker_:: Tracker_(CmdLine& cmd, detectors::DetectorBase* detector,vpMbTracker* tracker,bool flush_display) :
       cmd(cmd),
+      settings_(cmd),
+      has_pending_config_(false),
+      reconfigurations_(0),
       iter_(0),
-      flashcode_center_(640/2,480/2),
+      timestamp_(0.),
       detector_(detector),
-      tracker_(tracker),
-      flush_display_(flush_display){
+      qos_(cmd.get_qos_frame_period()),
+      qos_applied_(QosController::QOS_FULL),
+      me_sample_step_(0.),
+      budget_(cmd.get_frame_budget()),
+      decimation_(1),
+      refinements_(0),
+      has_loss_(false),
+      lost_frame_(0),
+      warm_restarts_(0),
+      budget_frame_(-1),
+      feature_margin_(0),
+      good_poses_(0),
+      last_good_frame_(0),
+      prev_good_frame_(0),
+      recovery_pending_(false),
+      recovery_attempts_(0),
+      fast_recoveries_(0),
+      tracker_(NULL),
+      edge_tracker_(NULL),
+      klt_tracker_(NULL),
+      default_tracker_(tracker),
+      registry_(NULL),
+      pattern_(NULL),
+      gray_(&Igray_),
+      flush_display_(flush_display),
+      display_thread_(NULL),
+      last_nb_covariance_(0){
     std::cout << "starting tracker" << std::endl;
+    last_covariance_.assign(0.);
+    if(cmd.get_verbose())
+      std::cout << "colour conversions use " << imgconv::get_isa_name() << " kernels" << std::endl;
+    set_tracker(tracker);
     cvTrackingBox_init_ = false;
     cvTrackingBox_.x = 0;
     cvTrackingBox_.y = 0;
@@ -35,21 +80,8 @@ namespace tracking{
     // Retrieve camera parameters comming from camera_info message in order to update them after loadConfigFile()
     tracker_->getCameraParameters(cam_); // init camera parameters
 
-    points3D_inner_ = cmd.get_inner_points_3D();
-    points3D_outer_ = cmd.get_outer_points_3D();
-    outer_points_3D_bcp_ = cmd.get_outer_points_3D();
-    if(cmd.using_adhoc_recovery() || cmd.log_checkpoints()){
-      for(unsigned int i=0;i<points3D_outer_.size();i++){
-        vpPoint p;
-        p.setWorldCoordinates(
-                  (points3D_outer_[i].get_oX()+points3D_inner_[i].get_oX())*cmd.get_adhoc_recovery_ratio(),
-                  (points3D_outer_[i].get_oY()+points3D_inner_[i].get_oY())*cmd.get_adhoc_recovery_ratio(),
-                  (points3D_outer_[i].get_oZ()+points3D_inner_[i].get_oZ())*cmd.get_adhoc_recovery_ratio()
-                );
-        points3D_middle_.push_back(p);
-      }
-    }
-    f_ = cmd.get_flashcode_points_3D();
+    set_pattern_points(cmd.get_flashcode_points_3D(),cmd.get_inner_points_3D(),cmd.get_outer_points_3D());
+    detector_->set_max_symbols(cmd.get_max_symbols());
 
     if(cmd.using_var_file()){
       varfile_.open(cmd.get_var_file().c_str(),std::ios::out);
@@ -66,26 +98,102 @@ namespace tracking{
       varfile_ << std::endl;
     }
 
+    //tracking quality tests, the chain runs them from the cheapest to the most expensive
+    monitors_.set_verbose(cmd.get_verbose());
+    monitors_.set_period(cmd.get_checkpoint_period());
+    if(cmd.using_var_limit())
+      monitors_.add(new VarLimitMonitor(cmd.get_var_limit()));
     if(cmd.using_hinkley()){
       if(cmd.get_verbose())
         std::cout << "Initialising hinkley with alpha=" << cmd.get_hinkley_alpha() << " and delta=" << cmd.get_hinkley_delta() << std::endl;
-      for(hinkley_array_t::iterator i = hink_.begin();i!=hink_.end();i++)
-        i->init(cmd.get_hinkley_alpha(),cmd.get_hinkley_delta());
+      monitors_.add(new HinkleyMonitor(cmd.get_hinkley_alpha(),cmd.get_hinkley_delta()));
     }
-
-    if(cmd.using_mbt_dynamic_range()){
-      vpMbEdgeTracker *tracker_me = dynamic_cast<vpMbEdgeTracker*>(tracker_);
-      if(tracker_me)
-        tracker_me->getMovingEdge(tracker_me_config_);
+    if(cmd.using_cusum())
+      monitors_.add(new CusumMonitor(cmd.get_cusum_k(),cmd.get_cusum_h()));
+    if(cmd.using_ewma())
+      monitors_.add(new EwmaMonitor(cmd.get_ewma_lambda(),cmd.get_ewma_width()));
+    if(cmd.using_pose_jump())
+      monitors_.add(new PoseJumpMonitor(cmd.get_pose_jump_translation(),cmd.get_pose_jump_rotation()));
+    if(cmd.using_adhoc_recovery() || cmd.log_checkpoints())
+      monitors_.add(new CheckpointMonitor(cmd.get_adhoc_recovery_size(),cmd.get_adhoc_recovery_treshold(),cmd.using_adhoc_recovery(),statistics.checkpoints));
+
+    if(settings_.using_mbt_dynamic_range){
+      if(edge_tracker_)
+        edge_tracker_->getMovingEdge(tracker_me_config_);
       else
         std::cout << "error: could not init moving edges on tracker that doesn't support them." << std::endl;
     }
 
-    tracker_->loadConfigFile(cmd.get_xml_file().c_str() ); // Load the configuration of the tracker
-    tracker_->loadModel(cmd.get_wrl_file().c_str()); // load the 3d model, to read .wrl model the 3d party library coin is required, if coin is not installed .cao file can be used.
+    boost::mutex::scoped_lock lock(get_model_loading_mutex());
+    tracker_->loadConfigFile(settings_.xml_file.c_str() ); // Load the configuration of the tracker
+    tracker_->loadModel(settings_.wrl_file.c_str()); // load the 3d model, to read .wrl model the 3d party library coin is required, if coin is not installed .cao file can be used.
     tracker_->setCameraParameters(cam_); // Set the good camera parameters coming from camera_info message
   }
 
+  void Tracker_:: set_tracker(vpMbTracker* tracker){
+    tracker_ = tracker;
+    //the only type checks of the tracker, the tracking path goes through these pointers
+    ParallelHybridTracker* parallel = dynamic_cast<ParallelHybridTracker*>(tracker);
+    if(parallel){
+      edge_tracker_ = &parallel->get_edge_tracker();
+      klt_tracker_ = &parallel->get_klt_tracker();
+      return;
+    }
+    edge_tracker_ = dynamic_cast<vpMbEdgeTracker*>(tracker); // For mbt and hybrid
+    klt_tracker_ = dynamic_cast<vpMbKltTracker*>(tracker);   // For klt and hybrid
+  }
+
+  void Tracker_:: set_pattern_points(const std::vector<vpPoint>& flashcode, const std::vector<vpPoint>& inner, const std::vector<vpPoint>& outer){
+    points3D_inner_ = inner;
+    points3D_outer_ = outer;
+    outer_points_3D_bcp_ = outer;
+    points3D_middle_.clear();
+    if(settings_.using_checkpoints()){
+      for(unsigned int i=0;i<points3D_outer_.size();i++){
+        vpPoint p;
+        p.setWorldCoordinates(
+                  (points3D_outer_[i].get_oX()+points3D_inner_[i].get_oX())*settings_.adhoc_recovery_ratio,
+                  (points3D_outer_[i].get_oY()+points3D_inner_[i].get_oY())*settings_.adhoc_recovery_ratio,
+                  (points3D_outer_[i].get_oZ()+points3D_inner_[i].get_oZ())*settings_.adhoc_recovery_ratio
+                );
+        points3D_middle_.push_back(p);
+      }
+    }
+    f_ = flashcode;
+    model_points_.assign(points3D_inner_,points3D_outer_,points3D_middle_);
+  }
+
+  void Tracker_:: select_pattern(const std::string& payload){
+    if(!registry_)
+      return;
+    //unknown payloads fall back to the pattern given on the command line
+    pattern_t* pattern = registry_->get(payload);
+    if(pattern==pattern_)
+      return;
+    if(settings_.verbose)
+      std::cout << "switching to the model of payload \"" << (pattern ? payload : std::string()) << "\"" << std::endl;
+    pattern_ = pattern;
+    //the features of the previous model mean nothing to the new one
+    has_loss_ = false;
+    //the outgoing tracker is left with its own sample step, the incoming one starts at full quality with its own.
+    //apply_qos degrades it again on the next tracked frame if needed
+    if(qos_applied_>=QosController::QOS_SPARSE_EDGES)
+      set_sparse_edges(false);
+    qos_applied_ = QosController::QOS_FULL;
+    if(pattern){
+      set_tracker(pattern->tracker);
+      set_pattern_points(pattern->flashcode,pattern->inner,pattern->outer);
+    }else{
+      set_tracker(default_tracker_);
+      set_pattern_points(cmd.get_flashcode_points_3D(),cmd.get_inner_points_3D(),cmd.get_outer_points_3D());
+    }
+    cvTrackingBox_init_ = false;
+  }
+
+  void Tracker_:: set_model_registry(ModelRegistry* registry){
+    registry_ = registry;
+  }
+
   detectors::DetectorBase& Tracker_:: get_detector(){
     return *detector_;
   }
@@ -111,6 +219,14 @@ namespace tracking{
     return f_;
   }
 
+  const ModelPoints& Tracker_:: get_model_points(){
+    return model_points_;
+  }
+
+  void Tracker_:: project_model(){
+    model_points_.project(cMo_,cam_);
+  }
+
   vpImage<vpRGBa>& Tracker_:: get_I(){
     return *I_;
   }
@@ -123,6 +239,26 @@ namespace tracking{
     return cmd;
   }
 
+  const tracker_settings_t& Tracker_:: get_settings() const{
+    return settings_;
+  }
+
+  PosePublisher& Tracker_:: get_pose_publisher(){
+    return pose_publisher_;
+  }
+
+  void Tracker_:: publish_pose(tracker_state_t state, bool valid){
+    pose_record_t record;
+    record.frame = iter_;
+    record.timestamp = timestamp_;
+    PosePublisher::fill(record,cMo_);
+    record.covariance = result_.covariance;
+    record.state = state;
+    record.valid = valid;
+    record.skipped = state==STATE_TRACK_MODEL && result_.skipped;
+    pose_publisher_.publish(record);
+  }
+
   template<>
   const cv::Rect& Tracker_:: get_tracking_box<cv::Rect>(){
     return cvTrackingBox_;
@@ -142,23 +278,201 @@ namespace tracking{
     return !input_selected(evt);
   }
 
-  bool Tracker_:: flashcode_detected(input_ready const& evt){
-    //this->cam_ = evt.cam_;
+  cv::Mat Tracker_:: detection_image(input_ready const& evt){
+    //luminance is enough for detectors, use it when the source provides it
+    if(evt.gray)
+      return cv::Mat((int)evt.gray->getRows(), (int)evt.gray->getCols(), CV_8UC1, (void*)evt.gray->bitmap);
+
+    //the buffer is kept from one frame to the other, it is only reallocated when the size changes
+    imgconv::convert(evt.I,bgr_);
+    return bgr_;
+  }
+
+  const vpImage<unsigned char>& Tracker_:: prepare_gray(input_ready const& evt){
+    if(evt.gray)
+      gray_ = evt.gray;
+    else{
+      imgconv::convert(evt.I,Igray_);
+      gray_ = &Igray_;
+    }
+    return *gray_;
+  }
 
-    cv::Mat rgba = cv::Mat((int)evt.I.getRows(), (int)evt.I.getCols(), CV_8UC4, (void*)evt.I.bitmap);
+  void Tracker_:: begin_frame(input_ready const& evt){
+    iter_ = evt.frame;
+    timestamp_ = evt.timestamp;
+    //a guard evaluated before this one on the same frame already started it
+    if(evt.frame==budget_frame_)
+      return;
+    budget_frame_ = evt.frame;
+    apply_config();
+    budget_.begin_frame();
+  }
+
+  bool Tracker_:: reconfigure(const ConfigDelta& delta, std::string& error){
+    //only options that do not change during the run are read here, the tracking thread may be running
+    if(delta.has(ConfigDelta::MBT_DYNAMIC_RANGE) && !settings_.using_mbt_dynamic_range){
+      error = "mbt-dynamic-range can only be tuned when the tracker was started with it";
+      return false;
+    }
+    if((delta.has(ConfigDelta::ADHOC_RECOVERY_THRESHOLD) || delta.has(ConfigDelta::ADHOC_RECOVERY_SIZE)) && !settings_.using_checkpoints()){
+      error = "checkpoints are disabled, start with ad-hoc-recovery or log-checkpoints to tune them";
+      return false;
+    }
+    boost::mutex::scoped_lock lock(config_mutex_);
+    pending_config_.merge(delta);
+    has_pending_config_ = true;
+    return true;
+  }
+
+  void Tracker_:: apply_config(){
+    if(!has_pending_config_)
+      return;
+    ConfigDelta delta;
+    {
+      boost::mutex::scoped_lock lock(config_mutex_);
+      delta.merge(pending_config_);
+      pending_config_.clear();
+      has_pending_config_ = false;
+    }
+    if(delta.has(ConfigDelta::MBT_DYNAMIC_RANGE))
+      settings_.mbt_dynamic_range = delta.get(ConfigDelta::MBT_DYNAMIC_RANGE);
+    if(delta.has(ConfigDelta::VARIANCE_LIMIT)){
+      settings_.using_var_limit = true;
+      settings_.var_limit = delta.get(ConfigDelta::VARIANCE_LIMIT);
+      VarLimitMonitor* monitor = dynamic_cast<VarLimitMonitor*>(monitors_.find("variance-limit"));
+      if(monitor)
+        monitor->set_limit(settings_.var_limit);
+      else
+        monitors_.add(new VarLimitMonitor(settings_.var_limit));
+    }
+    if(delta.has(ConfigDelta::HINKLEY_RANGE)){
+      double alpha = delta.get(ConfigDelta::HINKLEY_RANGE,0),
+             hinkley_delta = delta.get(ConfigDelta::HINKLEY_RANGE,1);
+      HinkleyMonitor* monitor = dynamic_cast<HinkleyMonitor*>(monitors_.find("hinkley"));
+      if(monitor)
+        monitor->set_range(alpha,hinkley_delta);
+      else
+        monitors_.add(new HinkleyMonitor(alpha,hinkley_delta));
+    }
+    CheckpointMonitor* checkpoints = dynamic_cast<CheckpointMonitor*>(monitors_.find("checkpoints"));
+    if(checkpoints && delta.has(ConfigDelta::ADHOC_RECOVERY_THRESHOLD))
+      checkpoints->set_threshold((unsigned int)delta.get(ConfigDelta::ADHOC_RECOVERY_THRESHOLD));
+    if(checkpoints && delta.has(ConfigDelta::ADHOC_RECOVERY_SIZE)){
+      settings_.adhoc_recovery_size = delta.get(ConfigDelta::ADHOC_RECOVERY_SIZE);
+      checkpoints->set_size(settings_.adhoc_recovery_size);
+    }
+    if(delta.has(ConfigDelta::DMX_TIMEOUT))
+      settings_.dmx_timeout = (int)delta.get(ConfigDelta::DMX_TIMEOUT);
+    if(delta.has(ConfigDelta::MBT_CONVERGENCE_STEPS))
+      settings_.mbt_convergence_steps = (int)delta.get(ConfigDelta::MBT_CONVERGENCE_STEPS);
+    if(delta.has(ConfigDelta::FAST_RECOVERY_STEPS))
+      settings_.fast_recovery_steps = (unsigned int)delta.get(ConfigDelta::FAST_RECOVERY_STEPS);
+    reconfigurations_++;
+    if(settings_.verbose){
+      std::cout << "reconfigured at frame " << iter_ << ":";
+      for(unsigned int i=0;i<ConfigDelta::NB_OPTIONS;i++)
+        if(delta.has((ConfigDelta::option_t)i))
+          std::cout << " " << ConfigDelta::get_name((ConfigDelta::option_t)i);
+      std::cout << std::endl;
+    }
+  }
+
+  unsigned int Tracker_:: get_reconfigurations() const{
+    return reconfigurations_;
+  }
+
+  void Tracker_:: update_feature_margin(){
+    feature_margin_ = 0;
+    if(edge_tracker_){
+      vpMe me;
+      edge_tracker_->getMovingEdge(me);
+      feature_margin_ += (int)(me.getRange()+me.getMaskSize());
+    }
+    if(klt_tracker_){
+      //the klt search reaches a window at the coarsest pyramid level
+      vpKltOpencv klt = klt_tracker_->getKltOpencv();
+      feature_margin_ += klt.getWindowSize()<<std::max(klt.getPyramidLevels(),0);
+    }
+  }
+
+  //box of the given groups of projected model points dilated by margin, clipped to the image
+  static cv::Rect model_box(const ModelPoints& points, bool all_groups, int margin, unsigned int width, unsigned int height){
+    double min_u = width, min_v = height, max_u = 0., max_v = 0.;
+    for(unsigned int g=ModelPoints::INNER;g<=(all_groups ? ModelPoints::MIDDLE : ModelPoints::OUTER);g++){
+      ModelPoints::group_t group = (ModelPoints::group_t)g;
+      for(unsigned int i=0;i<points.size(group);i++){
+        min_u = std::min(min_u,points.get_u(group,i));
+        min_v = std::min(min_v,points.get_v(group,i));
+        max_u = std::max(max_u,points.get_u(group,i));
+        max_v = std::max(max_v,points.get_v(group,i));
+      }
+    }
+    int x0 = std::max((int)min_u-margin,0),
+        y0 = std::max((int)min_v-margin,0),
+        x1 = std::min((int)max_u+margin+1,(int)width),
+        y1 = std::min((int)max_v+margin+1,(int)height);
+    return cv::Rect(x0,y0,std::max(x1-x0,0),std::max(y1-y0,0));
+  }
+
+  void Tracker_:: convert_roi(const vpImage<vpRGBa>& I, const cv::Rect& roi){
+    for(int v=roi.y;v<roi.y+roi.height;v++)
+      imgconv::rgba_to_gray((const unsigned char*)(I[v]+roi.x),Igray_[v]+roi.x,roi.width);
+  }
 
-    cv::Mat bgr = cv::Mat((int)evt.I.getRows(), (int)evt.I.getCols(), CV_8UC3);
-    cv::Mat alpha((int)evt.I.getRows(), (int)evt.I.getCols(), CV_8UC1);
+  int Tracker_:: tracking_margin(unsigned int decimation) const{
+    int margin = settings_.roi_margin + feature_margin_*(int)decimation;
+    if(settings_.using_mbt_dynamic_range)
+      margin += (int)(tracker_me_config_.getRange()*decimation_);
+    return margin;
+  }
+
+  const vpImage<unsigned char>& Tracker_:: prepare_tracking_gray(input_ready const& evt){
+    if(evt.gray || !settings_.using_roi_margin)
+      return prepare_gray(evt);
+    const vpImage<vpRGBa>& I = evt.I;
+    if(Igray_.getHeight()!=I.getHeight() || Igray_.getWidth()!=I.getWidth())
+      Igray_.resize(I.getHeight(),I.getWidth());
+    //moving edges and klt points are searched around the model projected at the prior pose
+    project_model();
+    gray_roi_ = model_box(model_points_,false,tracking_margin(get_decimation()),I.getWidth(),I.getHeight());
+    convert_roi(I,gray_roi_);
+    gray_ = &Igray_;
+    return Igray_;
+  }
 
-    cv::Mat out[] = {bgr, alpha};
-    // rgba[0] -> bgr[2], rgba[1] -> bgr[1],
-    // rgba[2] -> bgr[0], rgba[3] -> alpha[0]
-    int from_to[] = { 0,2,  1,1,  2,0,  3,3 };
-    cv::mixChannels(&rgba, 1, out, 2, from_to, 4);
+  void Tracker_:: complete_tracking_gray(input_ready const& evt, bool refining){
+    if(gray_!=&Igray_ || !settings_.using_roi_margin)
+      return;
+    //checkpoints read around the model at the new pose, which may have moved out of the converted region
+    project_model();
+    cv::Rect needed = model_box(model_points_,true,0,Igray_.getWidth(),Igray_.getHeight());
+    if(settings_.using_checkpoints()){
+      //a checkpoint region is at most the model size times --ad-hoc-recovery-size around its point
+      int margin = (int)std::ceil(std::abs(settings_.adhoc_recovery_size)*std::max(needed.width,needed.height))+1;
+      needed = model_box(model_points_,true,margin,Igray_.getWidth(),Igray_.getHeight());
+    }
+    //the full resolution refinement searches features around the new pose
+    if(refining)
+      needed |= model_box(model_points_,false,tracking_margin(1),Igray_.getWidth(),Igray_.getHeight());
+    if((needed & gray_roi_)==needed)
+      return;
+    imgconv::convert(evt.I,Igray_);
+    gray_roi_ = cv::Rect(0,0,Igray_.getWidth(),Igray_.getHeight());
+  }
 
-    //vpImageConvert::convert(evt.I,bgr);
+  bool Tracker_:: flashcode_detected(input_ready const& evt){
+    //this->cam_ = evt.cam_;
 
-    return detector_->detect(bgr,cmd.get_dmx_timeout(),0,0);
+    begin_frame(evt);
+    budget_.begin_stage(FrameBudget::STAGE_CONVERSION);
+    cv::Mat image = detection_image(evt);
+    budget_.begin_stage(FrameBudget::STAGE_DETECTION);
+    bool detected = detector_->detect(image,detection_timeout(settings_.dmx_timeout),0,0);
+    budget_.end_stage();
+    if(!detected)
+      publish_pose(STATE_DETECT_FLASHCODE,false);
+    return detected;
   }
 
   /*
@@ -168,39 +482,35 @@ namespace tracking{
   bool Tracker_:: flashcode_redetected(input_ready const& evt){
     //this->cam_ = evt.cam_;
 
-    //vpImageConvert::convert(evt.I,cvI);
-    cv::Mat rgba = cv::Mat((int)evt.I.getRows(), (int)evt.I.getCols(), CV_8UC4, (void*)evt.I.bitmap);
-
-    cv::Mat bgr = cv::Mat((int)evt.I.getRows(), (int)evt.I.getCols(), CV_8UC3);
-    cv::Mat alpha((int)evt.I.getRows(), (int)evt.I.getCols(), CV_8UC1);
-
-    cv::Mat out[] = {bgr, alpha};
-    // rgba[0] -> bgr[2], rgba[1] -> bgr[1],
-    // rgba[2] -> bgr[0], rgba[3] -> alpha[0]
-    int from_to[] = { 0,2,  1,1,  2,0,  3,3 };
-    cv::mixChannels(&rgba, 1, out, 2, from_to, 4);
-
+    begin_frame(evt);
+    budget_.begin_stage(FrameBudget::STAGE_CONVERSION);
+    cv::Mat image = detection_image(evt);
+    bool detected;
     if (cvTrackingBox_init_)
     {
-      cv::Mat subImage = cv::Mat(bgr,get_tracking_box<cv::Rect>()).clone();
+      cv::Mat(image,get_tracking_box<cv::Rect>()).copyTo(roi_);
+      cv::Mat& subImage = roi_;
 
-      double timeout = cmd.get_dmx_timeout()*(double)(get_tracking_box<cv::Rect>().width*get_tracking_box<cv::Rect>().height)/(double)(bgr.cols*bgr.rows);
-      return detector_->detect(subImage,(unsigned int)timeout,get_tracking_box<cv::Rect>().x,get_tracking_box<cv::Rect>().y);
+      double timeout = settings_.dmx_timeout*(double)(get_tracking_box<cv::Rect>().width*get_tracking_box<cv::Rect>().height)/(double)(image.cols*image.rows);
+      budget_.begin_stage(FrameBudget::STAGE_DETECTION);
+      detected = detector_->detect(subImage,detection_timeout(timeout),get_tracking_box<cv::Rect>().x,get_tracking_box<cv::Rect>().y);
     }
     else
     {
-      return detector_->detect(bgr,cmd.get_dmx_timeout(),0,0);
+      budget_.begin_stage(FrameBudget::STAGE_DETECTION);
+      detected = detector_->detect(image,detection_timeout(settings_.dmx_timeout),0,0);
     }
+    budget_.end_stage();
+    if(!detected)
+      publish_pose(STATE_REDETECT_FLASHCODE,false);
+    return detected;
   }
 
   void Tracker_:: find_flashcode_pos(input_ready const& evt){
     this->cam_ = evt.cam_;
+    select_pattern(detector_->get_message());
 
-    std::vector<cv::Point> polygon = detector_->get_polygon();
-    double centerX = (double)(polygon[0].x+polygon[1].x+polygon[2].x+polygon[3].x)/4.;
-    double centerY = (double)(polygon[0].y+polygon[1].y+polygon[2].y+polygon[3].y)/4.;
-    vpPixelMeterConversion::convertPoint(cam_, flashcode_center_, centerX, centerY);
-
+    const detectors::polygon_t& polygon = detector_->get_polygon();
     for(unsigned int i=0;i<f_.size();i++){
       double x=0, y=0;
       vpImagePoint poly_pt(polygon[i].y,polygon[i].x);
@@ -210,11 +520,12 @@ namespace tracking{
       f_[i].set_y(y);
     }
     I_ = _I = &(evt.I);
+    prepare_gray(evt);
   }
 
 
   bool Tracker_:: model_detected(msm::front::none const&){
-    vpImageConvert::convert(*I_,Igray_);
+    const vpImage<unsigned char>& I = *gray_;
     vpPose pose;
 
     for(unsigned int i=0;i<f_.size();i++)
@@ -224,153 +535,410 @@ namespace tracking{
     pose.computePose(vpPose::VIRTUAL_VS,cMo_);
     //vpDisplay::displayFrame(*I_,cMo_,cam_,0.01,vpColor::none,2);
 
-    std::vector<vpImagePoint> model_inner_corner(4);
-    std::vector<vpImagePoint> model_outer_corner(4);
-    for(unsigned int i=0;i<4;i++){
-      points3D_outer_[i].project(cMo_);
-      points3D_inner_[i].project(cMo_);
-      if(cmd.using_adhoc_recovery() || cmd.log_checkpoints())
-        points3D_middle_[i].project(cMo_);
-      vpMeterPixelConversion::convertPoint(cam_,points3D_outer_[i].get_x(),points3D_outer_[i].get_y(),model_outer_corner[i]);
-      vpMeterPixelConversion::convertPoint(cam_,points3D_inner_[i].get_x(),points3D_inner_[i].get_y(),model_inner_corner[i]);
-
-      if(cmd.get_verbose()){
-        std::cout << "model inner corner: (" << model_inner_corner[i].get_i() << "," << model_inner_corner[i].get_j() << ")" << std::endl;
-      }
+    project_model();
+    if(settings_.verbose){
+      for(unsigned int i=0;i<model_points_.size(ModelPoints::INNER);i++)
+        std::cout << "model inner corner: (" << model_points_.get_v(ModelPoints::INNER,i) << "," << model_points_.get_u(ModelPoints::INNER,i) << ")" << std::endl;
     }
 
+    budget_.begin_stage(FrameBudget::STAGE_MODEL_INIT);
     try{
-      tracker_->resetTracker();
-      tracker_->loadConfigFile(cmd.get_xml_file().c_str() );
-      tracker_->loadModel(cmd.get_wrl_file().c_str());
+      bool warm = can_warm_restart();
+      has_loss_ = false;
+      //trackers from the registry stay loaded, initFromPose below restarts them
+      bool reload = !pattern_ && !warm;
+      if(reload){
+        boost::mutex::scoped_lock lock(get_model_loading_mutex());
+        tracker_->resetTracker();
+        tracker_->loadConfigFile(settings_.xml_file.c_str() );
+        tracker_->loadModel(settings_.wrl_file.c_str());
+      }
       tracker_->setCameraParameters(cam_);
       {
           vpCameraParameters cam;
           tracker_->getCameraParameters(cam);
-          if (cam.get_px() != 558) ROS_INFO_STREAM("detection Camera parameters: \n" << cam_);
+          if (cam.get_px() != 558) std::cout << "detection Camera parameters: " << std::endl << cam_ << std::endl;
       }
 
-      tracker_->initFromPose(Igray_,cMo_);
+      result_.reset(iter_,timestamp_);
+      monitors_.reset();
+      //the tracker runs at full quality until the next tracked frame.
+      //A reloaded configuration already is, a kept tracker may still sample edges sparsely
+      if(!reload && qos_applied_>=QosController::QOS_SPARSE_EDGES)
+        set_sparse_edges(false);
+      qos_applied_ = QosController::QOS_FULL;
+      decimation_ = 1;
+      if(warm){
+        //klt points are moved to the new pose, those falling off their face are dropped and missing ones extracted
+        tracker_->setPose(I,cMo_);
+        warm_restarts_++;
+      }else
+        tracker_->initFromPose(I,cMo_);
 
-      tracker_->track(Igray_); // track the object on this image
+      tracker_->track(I); // track the object on this image
       tracker_->getPose(cMo_); // get the pose
       tracker_->setCovarianceComputation(true);
-      for(int i=0;i<cmd.get_mbt_convergence_steps();i++){
-        tracker_->track(Igray_); // track the object on this image
-        tracker_->getPose(cMo_); // get the pose
-      }
+      update_feature_margin();
+      result_.convergence_steps = converge();
+      statistics.convergence_steps(result_.convergence_steps);
+      if(settings_.verbose)
+        std::cout << "model converged in " << result_.convergence_steps << " steps" << std::endl;
+      store_covariance();
+      result_.cMo = cMo_;
     }catch(vpException& e){
       std::cout << "Tracking failed" << std::endl;
       std::cout << e.getStringMessage() << std::endl;
+      result_.verdict = TrackingResult::TRACKING_EXCEPTION;
+      result_.cMo = cMo_;
+      budget_.end_stage();
+      publish_pose(STATE_DETECT_MODEL,false);
       return false;
     }
+    budget_.end_stage();
+    //the pose prior of fast recovery starts over with the new model
+    good_poses_ = 0;
+    recovery_pending_ = false;
+    remember_good_pose();
+    publish_pose(STATE_DETECT_MODEL,true);
     return true;
   }
 
+  unsigned int Tracker_:: converge(){
+    int max_steps = settings_.mbt_convergence_steps;
+    bool early_stop = settings_.using_convergence_threshold || settings_.using_convergence_residual;
+    int steps = 0;
+    while(steps<max_steps){
+      previous_cMo_ = cMo_;
+      tracker_->track(*gray_); // track the object on this image
+      tracker_->getPose(cMo_); // get the pose
+      steps++;
+      if(budget_.exhausted())
+        break;
+      if(!early_stop)
+        continue;
+
+      bool converged = true;
+      if(settings_.using_convergence_threshold){
+        double translation,rotation;
+        pose_difference(previous_cMo_,cMo_,translation,rotation);
+        converged = translation<=settings_.convergence_translation && rotation<=settings_.convergence_rotation;
+      }
+      if(converged && settings_.using_convergence_residual){
+        //getError returns a copy, this one allocates: the residual test is an option of model initialisation
+        vpColVector error = tracker_->getError();
+        converged = error.getRows()>0 && std::sqrt(error.sumSquare()/error.getRows())<=settings_.convergence_residual;
+      }
+      if(converged)
+        break;
+    }
+    return steps;
+  }
+
+  void Tracker_:: apply_qos(){
+    QosController::level_t level = qos_.get_level();
+    if(settings_.verbose)
+      std::cout << "qos level: " << QosController::get_level_name(level) << std::endl;
+
+    monitors_.set_expensive_enabled(level<QosController::QOS_SKIP_CHECKPOINTS);
+
+    bool sparse = level>=QosController::QOS_SPARSE_EDGES,
+         was_sparse = qos_applied_>=QosController::QOS_SPARSE_EDGES;
+    if(sparse!=was_sparse)
+      set_sparse_edges(sparse);
+    qos_applied_ = level;
+  }
+
+  void Tracker_:: set_sparse_edges(bool sparse){
+    if(!edge_tracker_)
+      return;
+    vpMe me;
+    edge_tracker_->getMovingEdge(me);
+    if(sparse){
+      me_sample_step_ = me.getSampleStep();
+      me.setSampleStep(2*me_sample_step_);
+    }else
+      me.setSampleStep(me_sample_step_);
+    edge_tracker_->setMovingEdge(me);
+  }
+
+  unsigned int Tracker_:: get_decimation() const{
+    unsigned int decimation = settings_.mbt_decimation;
+    if(qos_applied_>=QosController::QOS_DECIMATED)
+      decimation *= 2;
+    return decimation;
+  }
+
+  void Tracker_:: refine(const vpImage<unsigned char>& I, const vpImage<unsigned char>& Idecimated){
+    //features are moved to the full resolution image and back, none is extracted again
+    tracker_->setCameraParameters(cam_);
+    tracker_->setPose(I,cMo_);
+    tracker_->track(I);
+    tracker_->getPose(cMo_);
+    result_.cMo = cMo_;
+    store_covariance();
+    tracker_->setCameraParameters(decimated_camera(cam_,decimation_));
+    tracker_->setPose(Idecimated,cMo_);
+    result_.refined = true;
+    refinements_++;
+  }
+
+  unsigned int Tracker_:: get_refinements() const{
+    return refinements_;
+  }
+
+  bool Tracker_:: can_warm_restart(){
+    if(!has_loss_ || settings_.klt_warm_restart==0 || iter_-lost_frame_>(int)settings_.klt_warm_restart)
+      return false;
+    //features tracked on a decimated image are not at full resolution coordinates
+    if(decimation_!=1)
+      return false;
+    return klt_tracker_!=NULL;
+  }
+
+  unsigned int Tracker_:: get_warm_restarts() const{
+    return warm_restarts_;
+  }
+
+  int Tracker_:: detection_timeout(double timeout){
+    if(!budget_.enabled())
+      return (int)timeout;
+    return (int)std::max(1.,std::min(timeout,budget_.get_detection_deadline()));
+  }
+
+  const FrameBudget& Tracker_:: get_frame_budget() const{
+    return budget_;
+  }
+
+  const QosController& Tracker_:: get_qos() const{
+    return qos_;
+  }
+
+  //vpMbTracker::getCovarianceMatrix returns a copy, this reads the tracker's matrix in place
+  struct covariance_access : public vpMbTracker{
+    static const vpMatrix& get(const vpMbTracker& tracker){
+      return tracker.*(&covariance_access::covarianceMatrix);
+    }
+  };
+
+  void Tracker_:: store_covariance(){
+    const vpMatrix& mat = covariance_access::get(*tracker_);
+    result_.nb_covariance = std::min(mat.getRows(),(unsigned int)result_.covariance.size());
+    for(unsigned int i=0;i<result_.nb_covariance;i++)
+      result_.covariance[i] = mat[i][i];
+  }
+
   bool Tracker_:: mbt_success(input_ready const& evt){
-    iter_ = evt.frame;
-    this->cam_ = evt.cam_;
+    begin_frame(evt);
+    result_.reset(iter_,timestamp_);
+    result_.qos_level = qos_.get_level();
+    if(qos_.skip_frame()){
+      //dropped to catch up with the camera, the previous pose and its covariance are held
+      result_.skipped = true;
+      result_.cMo = cMo_;
+      result_.covariance = last_covariance_;
+      result_.nb_covariance = last_nb_covariance_;
+      budget_.end_stage();
+      budget_.end_frame();
+      publish_pose(STATE_TRACK_MODEL,true);
+      return true;
+    }
+    double start = vpTime::measureTimeMs();
+    result_.verdict = track_frame(evt);
+    qos_.end_frame(vpTime::measureTimeMs()-start);
+    //the frame ends with its tracking, not when the next frame arrives
+    budget_.end_frame();
+    result_.cMo = cMo_;
+    if(settings_.using_var_file)
+      log_result();
+    last_covariance_ = result_.covariance;
+    last_nb_covariance_ = result_.nb_covariance;
+    publish_pose(STATE_TRACK_MODEL,result_.valid());
+    if(!result_.valid()){
+      has_loss_ = true;
+      lost_frame_ = iter_;
+      recovery_pending_ = true;
+    }else
+      remember_good_pose();
+    return result_.valid();
+  }
 
-    try{
-      LogFileWriter writer(varfile_); //the destructor of this class will act as a finally statement
-      vpImageConvert::convert(evt.I,Igray_);
+  void Tracker_:: remember_good_pose(){
+    //assignments between existing matrices, no allocation on the tracking path
+    prev_good_cMo_ = last_good_cMo_;
+    prev_good_frame_ = last_good_frame_;
+    last_good_cMo_ = cMo_;
+    last_good_frame_ = iter_;
+    good_poses_ = std::min(good_poses_+1,2u);
+  }
 
-      tracker_->track(Igray_); // track the object on this image
-      tracker_->getPose(cMo_);
-      vpMatrix mat = tracker_->getCovarianceMatrix();
-      if(cmd.using_var_file()){
-        writer.write(iter_);
-        for(unsigned int i=0;i<mat.getRows();i++)
-          writer.write(mat[i][i]);
+  vpHomogeneousMatrix Tracker_:: predict_pose() const{
+    vpHomogeneousMatrix predicted = last_good_cMo_;
+    int step = last_good_frame_-prev_good_frame_;
+    if(good_poses_<2 || step<=0)
+      return predicted;
+    //constant velocity: the motion between the last two good poses, once per elapsed interval
+    vpHomogeneousMatrix motion = last_good_cMo_*prev_good_cMo_.inverse();
+    int intervals = (iter_-last_good_frame_+step/2)/step;
+    for(int i=0;i<intervals;i++)
+      predicted = motion*predicted;
+    return predicted;
+  }
+
+  bool Tracker_:: pose_recovered(input_ready const& evt){
+    unsigned int steps = settings_.fast_recovery_steps;
+    //once per loss: the prior drifts away on the following frames, which are left to the detector
+    if(steps==0 || good_poses_==0 || !recovery_pending_)
+      return false;
+    recovery_pending_ = false;
+    begin_frame(evt);
+    this->cam_ = evt.cam_;
+    recovery_attempts_++;
+
+    budget_.begin_stage(FrameBudget::STAGE_CONVERSION);
+    const vpImage<unsigned char>& I = prepare_gray(evt);
+    budget_.begin_stage(FrameBudget::STAGE_TRACKING);
+    result_.reset(iter_,timestamp_);
+    result_.qos_level = qos_.get_level();
+    vpHomogeneousMatrix prior = predict_pose();
+    try{
+      //retrack at full resolution from the prior, track_frame goes back to the decimated image
+      if(decimation_!=1){
+        tracker_->setCameraParameters(cam_);
+        decimation_ = 1;
       }
-      if(cmd.using_var_limit())
-        for(unsigned int i=0; i<6; i++)
-          if(mat[i][i]>cmd.get_var_limit())
-            return false;
-      if(cmd.using_hinkley())
-        for(unsigned int i=0; i<6; i++){
-          if(hink_[i].testDownUpwardJump(mat[i][i]) != vpHinkley::noJump){
-            writer.write(mat[i][i]);
-            if(cmd.get_verbose())
-              std::cout << "Hinkley:detected jump!" << std::endl;
-            return false;
-          }
-        }
-      if(cmd.using_var_file() && cmd.using_mbt_dynamic_range())
-        writer.write(tracker_me_config_.getRange());
+      tracker_->setPose(I,prior);
+      for(unsigned int i=0;i<steps;i++)
+        tracker_->track(I);
+      tracker_->getPose(cMo_);
+      result_.cMo = cMo_;
+      store_covariance();
+      //the retracked pose is judged against the prior, not against the pose of the failing frame
+      monitors_.seed_pose(prior);
+      frame_context_t frame(result_,I,model_points_,cam_);
+      result_.verdict = monitors_.run(frame,false);
+    }catch(vpException& e){
+      result_.verdict = TrackingResult::TRACKING_EXCEPTION;
+    }
+    budget_.end_stage();
+    if(!result_.valid()){
+      if(settings_.verbose)
+        std::cout << "fast recovery failed, looking for the flashcode" << std::endl;
+      monitors_.reset();
+      return false;
+    }
+    if(settings_.verbose)
+      std::cout << "fast recovery from the pose prior" << std::endl;
+    fast_recoveries_++;
+    has_loss_ = false;
+    budget_.end_frame();
+    if(settings_.using_var_file)
+      log_result();
+    publish_pose(STATE_TRACK_MODEL,true);
+    remember_good_pose();
+    return true;
+  }
 
+  unsigned int Tracker_:: get_recovery_attempts() const{
+    return recovery_attempts_;
+  }
 
+  unsigned int Tracker_:: get_fast_recoveries() const{
+    return fast_recoveries_;
+  }
 
-      for(unsigned int i=0;i<mat.getRows();i++)
-        statistics.var(mat[i][i]);
+  TrackingResult::verdict_t Tracker_:: track_frame(input_ready const& evt){
+    this->cam_ = evt.cam_;
 
-      if(mat.getRows() == 6){ //if the covariance matrix is set
-        statistics.var_x(mat[0][0]);
-        statistics.var_y(mat[1][1]);
-        statistics.var_z(mat[2][2]);
-        statistics.var_wx(mat[3][3]);
-        statistics.var_wy(mat[4][4]);
-        statistics.var_wz(mat[5][5]);
+    try{
+      budget_.begin_stage(FrameBudget::STAGE_CONVERSION);
+      const vpImage<unsigned char>& I = prepare_tracking_gray(evt);
+      budget_.begin_stage(FrameBudget::STAGE_TRACKING);
+      if(qos_applied_!=qos_.get_level())
+        apply_qos();
+      unsigned int decimation = get_decimation();
+      if(decimation>1)
+        I.subsample(decimation,decimation,Idecimated_);
+      const vpImage<unsigned char>& Itrack = decimation>1 ? Idecimated_ : I;
+      if(decimation!=decimation_){
+        //features are moved to the new resolution like refine does, none is extracted again
+        tracker_->setCameraParameters(decimation>1 ? decimated_camera(cam_,decimation) : cam_);
+        tracker_->setPose(Itrack,cMo_);
+        decimation_ = decimation;
       }
 
-      if(cmd.using_var_file() && cmd.log_pose()){
-        vpPoseVector p(cMo_);
-        for(unsigned int i=0;i<p.getRows();i++)
-          writer.write(p[i]);
+      if(settings_.using_mbt_dynamic_range){
+        result_.has_me_range = true;
+        result_.me_range = tracker_me_config_.getRange();
+      }
+      tracker_->track(Itrack); // track the object on this image
+      tracker_->getPose(cMo_);
+      result_.cMo = cMo_;
+      store_covariance();
+
+      //the decimated pose is not accurate enough, polish it on the full resolution image
+      if(decimation>1 && settings_.using_refine_variance
+         && *std::max_element(result_.covariance.begin(),result_.covariance.begin()+result_.nb_covariance)>settings_.refine_variance){
+        complete_tracking_gray(evt,true);
+        refine(I,Itrack);
       }
 
-      if(cmd.using_adhoc_recovery() || cmd.log_checkpoints()){
-        for(unsigned int p=0;p<points3D_middle_.size();p++){
-          vpPoint& point3D = points3D_middle_[p];
-
-          double _u=0.,_v=0.,_u_inner=0.,_v_inner=0.;
-          point3D.project(cMo_);
-          vpMeterPixelConversion::convertPoint(cam_,point3D.get_x(),point3D.get_y(),_u,_v);
-          vpMeterPixelConversion::convertPoint(cam_,points3D_inner_[p].get_x(),points3D_inner_[p].get_y(),_u_inner,_v_inner);
-
-          boost::accumulators::accumulator_set<
-                  unsigned char,
-                  boost::accumulators::stats<
-                    boost::accumulators::tag::median(boost::accumulators::with_p_square_quantile)
-                  >
-                > acc;
-
-          int region_width= std::max((int)(std::abs(_u-_u_inner)*cmd.get_adhoc_recovery_size()),1);
-          int region_height=std::max((int)(std::abs(_v-_v_inner)*cmd.get_adhoc_recovery_size()),1);
-          int u=(int)_u;
-          int v=(int)_v;
-          for(int i=std::max(u-region_width,0);
-              i<std::min(u+region_width,(int)evt.I.getWidth());
-              i++){
-            for(int j=std::max(v-region_height,0);
-                j<std::min(v+region_height,(int)evt.I.getHeight());
-                j++){
-              acc(Igray_[j][i]);
-              statistics.checkpoints(Igray_[j][i]);
-            }
-          }
-          double checkpoints_median = boost::accumulators::median(acc);
-          if(cmd.using_var_file() && cmd.log_checkpoints())
-            writer.write(checkpoints_median);
-          if( cmd.using_adhoc_recovery() && (unsigned int)checkpoints_median>cmd.get_adhoc_recovery_treshold() )
-            return false;
-        }
-
+      complete_tracking_gray(evt,false);
+      frame_context_t frame(result_,I,model_points_,cam_);
+      TrackingResult::verdict_t verdict = monitors_.run(frame,budget_.exhausted());
+      if(verdict!=TrackingResult::TRACKING_OK){
+        budget_.end_stage();
+        return verdict;
+      }
 
+      const boost::array<double,6>& var = result_.covariance;
+      for(unsigned int i=0;i<result_.nb_covariance;i++)
+        statistics.var(var[i]);
+
+      if(result_.nb_covariance == 6){ //if the covariance matrix is set
+        statistics.var_x(var[0]);
+        statistics.var_y(var[1]);
+        statistics.var_z(var[2]);
+        statistics.var_wx(var[3]);
+        statistics.var_wy(var[4]);
+        statistics.var_wz(var[5]);
       }
     }catch(vpException& e){
+      budget_.end_stage();
       std::cout << "Tracking lost" << std::endl;
-      return false;
+      return TrackingResult::TRACKING_EXCEPTION;
     }
-    return true;
+    budget_.end_stage();
+    return TrackingResult::TRACKING_OK;
+  }
+
+  void Tracker_:: log_result(){
+    LogFileWriter writer(varfile_); //the destructor of this class ends the line
+    writer.write(result_.frame);
+    for(unsigned int i=0;i<result_.nb_covariance;i++)
+      writer.write(result_.covariance[i]);
+    if(result_.has_me_range)
+      writer.write(result_.me_range);
+    if(settings_.log_pose){
+      pose_scratch_.buildFrom(result_.cMo);
+      for(unsigned int i=0;i<pose_scratch_.getRows();i++)
+        writer.write(pose_scratch_[i]);
+    }
+    if(settings_.log_checkpoints)
+      for(unsigned int i=0;i<result_.nb_checkpoints;i++)
+        writer.write(result_.checkpoint_medians[i]);
+  }
+
+  const TrackingResult& Tracker_:: get_tracking_result() const{
+    return result_;
   }
 
   void Tracker_:: track_model(input_ready const& evt){
     this->cam_ = evt.cam_;
 
-    std::vector<cv::Point> points;
     I_ = _I = &(evt.I);
-    vpImageConvert::convert(evt.I,Igray_);
+    //the pose of a skipped frame is the held one, the model box and range are still right
+    if(result_.skipped)
+      return;
 
     boost::accumulators::accumulator_set<
                       double,
@@ -379,40 +947,45 @@ namespace tracking{
                       >
                     > acc;
 
-    for(unsigned int i=0;i<points3D_outer_.size();i++){
-      points3D_outer_[i].project(cMo_);
-      points3D_inner_[i].project(cMo_);
-
-      double u=0.,v=0.,u_inner=0.,v_inner=0;
-      vpMeterPixelConversion::convertPoint(cam_,points3D_outer_[i].get_x(),points3D_outer_[i].get_y(),u,v);
-      vpMeterPixelConversion::convertPoint(cam_,points3D_inner_[i].get_x(),points3D_inner_[i].get_y(),u_inner,v_inner);
-      points.push_back(cv::Point(u,v));
+    project_model();
+    //bounding box of the outer corners, same as cv::boundingRect without building a point matrix
+    int min_x = INT_MAX, min_y = INT_MAX, max_x = INT_MIN, max_y = INT_MIN;
+    for(unsigned int i=0;i<model_points_.size(ModelPoints::OUTER);i++){
+      double u = model_points_.get_u(ModelPoints::OUTER,i),
+             v = model_points_.get_v(ModelPoints::OUTER,i),
+             u_inner = model_points_.get_u(ModelPoints::INNER,i),
+             v_inner = model_points_.get_v(ModelPoints::INNER,i);
+      int x = (int)u, y = (int)v;
+      min_x = std::min(min_x,x);
+      min_y = std::min(min_y,y);
+      max_x = std::max(max_x,x);
+      max_y = std::max(max_y,y);
 
       acc(std::abs(u-u_inner));
       acc(std::abs(v-v_inner));
     }
 
-    if(cmd.using_mbt_dynamic_range()){
-      int range = (const unsigned int)(boost::accumulators::mean(acc)*cmd.get_mbt_dynamic_range());
+    if(settings_.using_mbt_dynamic_range){
+      int range = (const unsigned int)(boost::accumulators::mean(acc)*settings_.mbt_dynamic_range);
+      if(decimation_>1)
+        range = std::max(range/(int)decimation_,1);
 
-      vpMbEdgeTracker *tracker_me = dynamic_cast<vpMbEdgeTracker*>(tracker_);
-      if(tracker_me){
-        tracker_me->getMovingEdge(tracker_me_config_);
+      if(edge_tracker_){
+        edge_tracker_->getMovingEdge(tracker_me_config_);
         tracker_me_config_.setRange(range);
-        tracker_me->setMovingEdge(tracker_me_config_);
+        edge_tracker_->setMovingEdge(tracker_me_config_);
       }else
         std::cout << "error: could not init moving edges on tracker that doesn't support them." << std::endl;
     }
     cvTrackingBox_init_ = true;
-    cvTrackingBox_ = cv::boundingRect(cv::Mat(points));
-    int s_x = cvTrackingBox_.x,
-        s_y = cvTrackingBox_.y,
-        d_x = cvTrackingBox_.x + cvTrackingBox_.width,
-        d_y = cvTrackingBox_.y + cvTrackingBox_.height;
+    int s_x = min_x,
+        s_y = min_y,
+        d_x = max_x + 1,
+        d_y = max_y + 1;
     s_x = std::max(s_x,0);
     s_y = std::max(s_y,0);
-    d_x = std::min(d_x,(int)evt.I.getWidth());
-    d_y = std::min(d_y,(int)evt.I.getHeight());
+    d_x = std::min(d_x,(int)gray_->getWidth());
+    d_y = std::min(d_y,(int)gray_->getHeight());
     cvTrackingBox_.x = s_x;
     cvTrackingBox_.y = s_y;
     cvTrackingBox_.width = d_x - s_x;
@@ -432,80 +1005,84 @@ namespace tracking{
     return flush_display_;
   }
 
+  void Tracker_:: set_display_thread(DisplayThread* display_thread){
+    display_thread_ = display_thread;
+  }
+
+  DisplayThread* Tracker_:: get_display_thread(){
+    return display_thread_;
+  }
+
+  void Tracker_:: post_display(const vpImage<vpRGBa>& I, tracker_state_t state){
+    if(!display_thread_)
+      return;
+    display_frame_t* frame = display_thread_->begin_frame(iter_);
+    if(!frame)
+      return;
+    frame->I = I;
+    frame->state = state;
+    frame->result = result_;
+    frame->cam = cam_;
+    const detectors::polygon_t& polygon = detector_->get_polygon();
+    frame->nb_corners = polygon.size()==4 ? 4 : 0;
+    for(unsigned int i=0;i<frame->nb_corners;i++)
+      frame->corners[i] = vpImagePoint(polygon[i].y,polygon[i].x);
+    frame->model_points = model_points_;
+    display_thread_->submit();
+  }
+
   void
-  Tracker_::updateMovingEdgeSites(visp_tracker::MovingEdgeSitesPtr sites)
+  Tracker_::exportMovingEdgeSites(moving_edge_sites_t& sites)
   {
-    if (!sites)
-      return;
+    sites.clear();
 
-    std::list<vpMbtDistanceLine*> linesList;
+    if(!edge_tracker_)
+      return;
 
-    if(cmd.get_tracker_type() != CmdLine::KLT) // For mbt and hybrid
-      dynamic_cast<vpMbEdgeTracker*>(tracker_)->getLline(linesList, 0);
+    //the list is a member so that its nodes are reused from one call to the other
+    edge_tracker_->getLline(lines_scratch_, 0);
 
-    std::list<vpMbtDistanceLine*>::iterator linesIterator = linesList.begin();
-    if (linesList.empty())
-      ROS_DEBUG_THROTTLE(10, "no distance lines");
-    bool noVisibleLine = true;
-    for (; linesIterator != linesList.end(); ++linesIterator)
+    for (std::list<vpMbtDistanceLine*>::const_iterator linesIterator = lines_scratch_.begin(); linesIterator != lines_scratch_.end(); ++linesIterator)
     {
       vpMbtDistanceLine* line = *linesIterator;
 
       if (line && line->isVisible() && line->meline)
       {
-        if (line->meline->list.empty()) {
-          ROS_DEBUG_THROTTLE(10, "no moving edge for a line");
-        }
-
-        std::list<vpMeSite>::const_iterator sitesIterator = line->meline->list.begin();
-
-        for (; sitesIterator != line->meline->list.end(); ++sitesIterator)
+        for (std::list<vpMeSite>::const_iterator sitesIterator = line->meline->list.begin(); sitesIterator != line->meline->list.end(); ++sitesIterator)
         {
-          visp_tracker::MovingEdgeSite movingEdgeSite;
-          movingEdgeSite.x = sitesIterator->ifloat;
-          movingEdgeSite.y = sitesIterator->jfloat;
-          movingEdgeSite.suppress = sitesIterator->suppress;
-          sites->moving_edge_sites.push_back (movingEdgeSite);
+          sites.x.push_back(sitesIterator->ifloat);
+          sites.y.push_back(sitesIterator->jfloat);
+          sites.suppress.push_back(sitesIterator->suppress);
         }
-        noVisibleLine = false;
-
       }
     }
-    if (noVisibleLine)
-      ROS_DEBUG_THROTTLE(10, "no distance lines");
   }
 
   void
-  Tracker_::updateKltPoints(visp_tracker::KltPointsPtr klt)
+  Tracker_::exportKltPoints(klt_points_t& klt)
   {
-    if (!klt)
-      return;
+    klt.clear();
 
-    vpMbHiddenFaces<vpMbtKltPolygon> *poly_lst;
-    std::map<int, vpImagePoint> *map_klt;
-
-    if(cmd.get_tracker_type() != CmdLine::MBT) // For klt and hybrid
-      poly_lst = &dynamic_cast<vpMbKltTracker*>(tracker_)->getFaces();
+    if(!klt_tracker_)
+      return;
 
-    for(unsigned int i = 0 ; i < poly_lst->size() ; i++)
+    vpMbHiddenFaces<vpMbtKltPolygon>& poly_lst = klt_tracker_->getFaces();
+    for(unsigned int i = 0 ; i < poly_lst.size() ; i++)
     {
-      if((*poly_lst)[i])
+      if(poly_lst[i])
       {
-        map_klt = &((*poly_lst)[i]->getCurrentPoints());
+        std::map<int, vpImagePoint>& map_klt = poly_lst[i]->getCurrentPoints();
 
-        if(map_klt->size() > 3)
+        if(map_klt.size() > 3)
         {
-          for (std::map<int, vpImagePoint>::iterator it=map_klt->begin(); it!=map_klt->end(); ++it)
+          for (std::map<int, vpImagePoint>::const_iterator it=map_klt.begin(); it!=map_klt.end(); ++it)
           {
-            visp_tracker::KltPoint kltPoint;
-            kltPoint.id = it->first;
-            kltPoint.i = it->second.get_i();
-            kltPoint.j = it->second.get_j();
-            klt->klt_points_positions.push_back (kltPoint);
+            klt.id.push_back(it->first);
+            klt.i.push_back(it->second.get_i());
+            klt.j.push_back(it->second.get_j());
           }
         }
       }
     }
   }
 }
-
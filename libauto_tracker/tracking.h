@@ -11,6 +11,8 @@
 //front-end
 #include <boost/msm/front/state_machine_def.hpp>
 #include <boost/array.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
 #include <visp/vpImage.h>
 
 
@@ -22,17 +24,27 @@
 #include <visp/vpDisplay.h>
 #include <visp/vpHinkley.h>
 #include <visp/vpMe.h>
+#include <visp/vpPoseVector.h>
 #include <vector>
 #include <fstream>
 
-#include "visp_tracker/MovingEdgeSites.h"
-#include "visp_tracker/KltPoints.h"
-
 #include "cmd_line/cmd_line.h"
 #include "detectors/detector_base.h"
 #include <visp/vpMbEdgeTracker.h>
+#include <visp/vpMbKltTracker.h>
 #include "states.hpp"
 #include "events.h"
+#include "pose_publisher.h"
+#include "feature_export.h"
+#include "model_points.h"
+#include "tracking_result.h"
+#include "monitors.h"
+#include "qos.h"
+#include "frame_budget.h"
+#include "display_thread.h"
+#include "model_registry.h"
+#include "tracker_settings.h"
+#include "config_delta.h"
 
 using namespace boost::accumulators;
 namespace msm = boost::msm;
@@ -42,55 +54,150 @@ namespace tracking{
   class Tracker_ : public msm::front::state_machine_def<Tracker_>{
   public:
     typedef struct {
-      boost::accumulators::accumulator_set<
-        double,
-        boost::accumulators::stats<
-          boost::accumulators::tag::median(boost::accumulators::with_p_square_quantile),
-          boost::accumulators::tag::max,
-          boost::accumulators::tag::mean
-        >
-      > var,var_x,var_y,var_z,var_wx,var_wy,var_wz,checkpoints;
+      summary_accumulator_t var,var_x,var_y,var_z,var_wx,var_wy,var_wz,checkpoints;
+      summary_accumulator_t convergence_steps;
 
     } statistics_t;
   private:
     CmdLine cmd;
+    tracker_settings_t settings_; //cmd options read on every frame, tuned between frames by reconfigure
+    //deltas handed by reconfigure, applied by the tracking thread when the next frame starts
+    boost::mutex config_mutex_;
+    ConfigDelta pending_config_;
+    boost::atomic<bool> has_pending_config_;
+    unsigned int reconfigurations_;
     int iter_;
-    vpImagePoint flashcode_center_;
+    double timestamp_;
     std::ofstream varfile_;
     detectors::DetectorBase* detector_;
-    typedef boost::array<vpHinkley,6> hinkley_array_t;
-    hinkley_array_t hink_;
+    MonitorChain monitors_;
+    QosController qos_;
+    QosController::level_t qos_applied_; //level the visp tracker is currently configured for
+    double me_sample_step_;              //moving edge sample step before QOS_SPARSE_EDGES
+    FrameBudget budget_;
+    unsigned int decimation_;            //subsampling factor of the image the visp tracker is configured for
+    unsigned int refinements_;
+    bool has_loss_;                      //tracking was lost since the last model detection
+    int lost_frame_;
+    unsigned int warm_restarts_;
+    int budget_frame_;                   //last frame started in the budget
+    int feature_margin_;                 //pixels around the model the visp tracker may read, at full resolution
+    cv::Rect gray_roi_;                  //part of Igray_ converted for the current frame
+    //last two good poses, prior of the fast recovery
+    unsigned int good_poses_;
+    vpHomogeneousMatrix last_good_cMo_,prev_good_cMo_;
+    int last_good_frame_,prev_good_frame_;
+    bool recovery_pending_;              //the last loss has not been given its fast recovery attempt yet
+    unsigned int recovery_attempts_,fast_recoveries_;
 
     vpMbTracker* tracker_; // Create a model based tracker.
+    vpMbEdgeTracker* edge_tracker_; //tracker_ (or its edge part) if it tracks moving edges, NULL otherwise
+    vpMbKltTracker* klt_tracker_;   //tracker_ (or its klt part) if it tracks klt points, NULL otherwise
+    vpMbTracker* default_tracker_; //tracker of the pattern given on the command line
+    ModelRegistry* registry_;
+    pattern_t* pattern_;           //pattern being tracked, NULL for the command line one
     vpMe tracker_me_config_;
     vpImage<vpRGBa> *I_;
     vpImage<vpRGBa> *_I;
     vpHomogeneousMatrix cMo_; // Pose computed using the tracker.
     vpCameraParameters cam_;
     vpImage<unsigned char> Igray_;
+    const vpImage<unsigned char>* gray_; //luminance of the current frame: Igray_ or the image given by the source
+    vpImage<unsigned char> Idecimated_;
 
     std::vector<vpPoint> outer_points_3D_bcp_;
     std::vector<vpPoint> points3D_inner_;
     std::vector<vpPoint> points3D_outer_;
     std::vector<vpPoint> points3D_middle_;
     std::vector<vpPoint> f_;
+    ModelPoints model_points_;
     vpRect vpTrackingBox_;
     cv::Rect cvTrackingBox_;
     bool cvTrackingBox_init_;
 
     statistics_t statistics;
     bool flush_display_;
+    DisplayThread* display_thread_;
+
+    PosePublisher pose_publisher_;
+    TrackingResult result_;
+    boost::array<double,6> last_covariance_; //of the last tracked frame, held by the frames the qos controller skips
+    unsigned int last_nb_covariance_;
+    //diagonal of the covariance of the visp tracker into result_
+    void store_covariance();
+    //projects the model contours at cMo_, no-op if the pose did not change
+    void project_model();
+    void publish_pose(tracker_state_t state, bool valid);
+    TrackingResult::verdict_t track_frame(input_ready const& evt);
+    void log_result();
+    //tracks Igray_ until the pose settles or the iteration cap is reached, returns the number of iterations
+    unsigned int converge();
+    //configures the visp tracker and the monitors for the current qos level
+    void apply_qos();
+    //doubles the moving edge sample step, or restores it
+    void set_sparse_edges(bool sparse);
+    //sets the current frame and starts its time budget, once per frame whatever the guards evaluated
+    void begin_frame(input_ready const& evt);
+    //applies the pending configuration delta if any, between two frames
+    void apply_config();
+    //shifts the good pose history with cMo_
+    void remember_good_pose();
+    //last good pose moved at constant velocity up to the current frame
+    vpHomogeneousMatrix predict_pose() const;
+    //subsampling factor for tracking: --mbt-decimation, doubled at QOS_DECIMATED
+    unsigned int get_decimation() const;
+    //tracks the full resolution image I from the current pose, then moves the tracker back to Idecimated
+    void refine(const vpImage<unsigned char>& I, const vpImage<unsigned char>& Idecimated);
+    //BGR image of the frame for the detectors, or a view on its luminance when the event carries it
+    cv::Mat detection_image(input_ready const& evt);
+    //makes gray_ point to the luminance of the frame, converting it if needed
+    const vpImage<unsigned char>& prepare_gray(input_ready const& evt);
+    //same as prepare_gray but with --roi-margin only the pixels the tracker reads around the prior pose are converted,
+    //the rest of Igray_ is left from previous frames
+    const vpImage<unsigned char>& prepare_tracking_gray(input_ready const& evt);
+    //pixels around the model the tracker may read on an image decimated by decimation, in full resolution pixels
+    int tracking_margin(unsigned int decimation) const;
+    //converts the whole frame if the model at the new pose, with its checkpoints and the features of a
+    //full resolution refinement when refining, left the converted region
+    void complete_tracking_gray(input_ready const& evt, bool refining);
+    void convert_roi(const vpImage<vpRGBa>& I, const cv::Rect& roi);
+    //search range of moving edges and klt points, read from the visp tracker once configured
+    void update_feature_margin();
+    //true when the klt features from before the last loss can be reused at the new pose
+    bool can_warm_restart();
+    //sets tracker_ and resolves its kind once, see edge_tracker_ and klt_tracker_
+    void set_tracker(vpMbTracker* tracker);
+    //replaces the 3D points of the pattern and the derived checkpoints
+    void set_pattern_points(const std::vector<vpPoint>& flashcode, const std::vector<vpPoint>& inner, const std::vector<vpPoint>& outer);
+    //switches tracker and points to the pattern registered for payload
+    void select_pattern(const std::string& payload);
+    //detector timeout bounded by the frame budget
+    int detection_timeout(double timeout);
+
+    //per-frame buffers kept across frames so that steady state tracking does not allocate
+    cv::Mat bgr_;            //detection image built from RGBA
+    cv::Mat roi_;            //tracking box cropped for redetection
+    vpPoseVector pose_scratch_;
+    std::list<vpMbtDistanceLine*> lines_scratch_;
+    vpHomogeneousMatrix previous_cMo_; //pose before the last convergence iteration
 
   public:
     //getters to access useful members
     void set_flush_display(bool val);
     bool get_flush_display();
+    //renders on a separate thread instead of flushing the display in the state hooks, NULL to disable
+    void set_display_thread(DisplayThread* display_thread);
+    DisplayThread* get_display_thread();
+    //hands a snapshot of the image and of the current result to the display thread, if any
+    void post_display(const vpImage<vpRGBa>& I, tracker_state_t state);
     detectors::DetectorBase& get_detector();
     vpMbTracker& get_mbt();
     std::vector<vpPoint>& get_points3D_inner();
     std::vector<vpPoint>& get_points3D_outer();
     std::vector<vpPoint>& get_points3D_middle();
     std::vector<vpPoint>& get_flashcode();
+    //model contours projected at the current pose, see project_model
+    const ModelPoints& get_model_points();
 
     //returns tracking box where to look for pattern (may be full image)
     template<class T>
@@ -101,6 +208,30 @@ namespace tracking{
     vpCameraParameters& get_cam();
     //returns tracker configuration
     CmdLine& get_cmd();
+    //returns the options read on every frame, looked up once in get_cmd()
+    const tracker_settings_t& get_settings() const;
+    //returns the publisher delivering one pose record per processed frame
+    PosePublisher& get_pose_publisher();
+    //returns the qos controller and its metrics
+    const QosController& get_qos() const;
+    //returns the per-frame time budget and its metrics
+    const FrameBudget& get_frame_budget() const;
+    //looks up the pattern of each detected payload in registry, NULL to always track the command line pattern
+    void set_model_registry(ModelRegistry* registry);
+    //returns how many decimated frames were refined at full resolution
+    unsigned int get_refinements() const;
+    //returns how many model detections reused the klt features from before the loss
+    unsigned int get_warm_restarts() const;
+    //returns how many losses were retracked from the pose prior, and how many times it was tried
+    unsigned int get_fast_recoveries() const;
+    unsigned int get_recovery_attempts() const;
+    //returns how many configuration deltas were applied
+    unsigned int get_reconfigurations() const;
+
+    //changes tuning options of the running tracker, from any thread. The model and the tracking state are kept.
+    //The delta is checked against the tracker here and applied as a whole when the next frame starts,
+    //on refusal nothing is applied and error says why
+    bool reconfigure(const ConfigDelta& delta, std::string& error);
 
     //constructor
     //inits tracker from a detector, a visp tracker
@@ -115,6 +246,7 @@ namespace tracking{
     bool flashcode_redetected(input_ready const& evt);
     bool model_detected(msm::front::none const&);
     bool mbt_success(input_ready const& evt);
+    bool pose_recovered(input_ready const& evt);
 
     //actions
     void find_flashcode_pos(input_ready const& evt);
@@ -122,9 +254,12 @@ namespace tracking{
 
     //gets statistics about the last tracking experience
     statistics_t& get_statistics();
+    //gets the outcome of the last tracked frame
+    const TrackingResult& get_tracking_result() const;
 
-    void updateMovingEdgeSites(visp_tracker::MovingEdgeSitesPtr sites);
-    void updateKltPoints(visp_tracker::KltPointsPtr klt);
+    //fill caller-owned buffers with the current features. Buffers are cleared but keep their capacity
+    void exportMovingEdgeSites(moving_edge_sites_t& sites);
+    void exportKltPoints(klt_points_t& klt);
 
     //here is how the tracker works
     struct transition_table : mpl::vector<
@@ -152,7 +287,7 @@ namespace tracking{
       //   +------------------+--------------------+-----------------------+------------------------------+------------------------------+
         row< ReDetectFlashcode, input_ready        , DetectModel           , &Tracker_::find_flashcode_pos,&Tracker_::flashcode_redetected >,
       //   +------------------+--------------------+-----------------------+------------------------------+------------------------------+
-      //row< ReDetectFlashcode, input_ready        , TrackModel            , &Tracker_::track_model       ,&Tracker_::mbt_success          >,
+        row< ReDetectFlashcode, input_ready        , TrackModel            , &Tracker_::track_model       ,&Tracker_::pose_recovered       >,
       //   +------------------+--------------------+-----------------------+------------------------------+------------------------------+
        _row< TrackModel       , finished           , Finished                                                                              >,
       //   +------------------+--------------------+-----------------------+------------------------------+------------------------------+
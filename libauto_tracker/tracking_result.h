@@ -0,0 +1,62 @@
+#ifndef __TRACKING_RESULT_H__
+#define __TRACKING_RESULT_H__
+#include <boost/array.hpp>
+#include <visp/vpHomogeneousMatrix.h>
+
+namespace tracking{
+  /*
+   * What the tracker learnt about one frame.
+   * Built once per frame by Tracker_ and handed out read-only (see Tracker_::get_tracking_result)
+   * so that guards, states, loggers and plots never query the visp tracker again.
+   */
+  struct TrackingResult{
+    enum verdict_t{
+      TRACKING_OK,
+      VARIANCE_LIMIT,     //a pose variance went above --variance-limit
+      HINKLEY_JUMP,       //a hinkley test detected a jump in the variances
+      CUSUM_DRIFT,        //the cusum test on the variances reached its threshold
+      POSE_JUMP,          //the pose moved too much since the last frame
+      CHECKPOINT_FAILED,  //a checkpoint region is not black anymore
+      TRACKING_EXCEPTION  //visp could not track the model
+    };
+    static const unsigned int MAX_CHECKPOINTS = 8;
+
+    int frame;
+    double timestamp;
+    vpHomogeneousMatrix cMo;
+    boost::array<double,6> covariance; //diagonal of the pose covariance matrix
+    unsigned int nb_covariance;        //number of valid entries in covariance
+    bool has_me_range;
+    double me_range;                   //moving edge range used for this frame
+    boost::array<double,MAX_CHECKPOINTS> checkpoint_medians;
+    unsigned int nb_checkpoints;       //number of checkpoint medians computed for this frame
+    unsigned int convergence_steps;    //track() iterations run to converge on this frame, 0 unless the model was initialised
+    unsigned int qos_level;            //QosController::level_t the frame was processed at
+    bool skipped;                      //the frame was dropped by the qos controller, the pose is the previous one
+    bool refined;                      //the pose tracked on a decimated image was refined at full resolution
+    verdict_t verdict;
+
+    TrackingResult(){
+      reset(0,0.);
+    }
+    void reset(int frame, double timestamp){
+      this->frame = frame;
+      this->timestamp = timestamp;
+      covariance.assign(0.);
+      nb_covariance = 0;
+      has_me_range = false;
+      me_range = 0.;
+      checkpoint_medians.assign(0.);
+      nb_checkpoints = 0;
+      convergence_steps = 0;
+      qos_level = 0;
+      skipped = false;
+      refined = false;
+      verdict = TRACKING_OK;
+    }
+    bool valid() const{
+      return verdict == TRACKING_OK;
+    }
+  };
+}
+#endif /* __TRACKING_RESULT_H__ */
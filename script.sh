@@ -1,41 +1,20 @@
 #!/bin/bash
-./tracking -c "/home/fnovotny/playground/flashcode_mbt/data/config.cfg" -v -D ../flashcode_mbt/data/ -S 5 -r zbar > out.log
-names=( "median" "mean" "max" )
-for name in ${names[@]}
-do
-    echo $name
-    i=0
-    for medianline in $(cat out.log | grep $name)
-    do
-	medianlines[$i]=${medianline:`expr ${#name} + 1`}
-	i=`expr $i + 1`
-    done
-    echo "start of file" > $name.txt
-    echo "0 ${medianlines[0]} ${medianlines[1]} ${medianlines[2]} ${medianlines[3]} ${medianlines[4]} ${medianlines[5]} ${medianlines[6]}" >> $name.txt
-done
-
+# Sweeps the mbt dynamic range (-R) in a single process: the sequence is decoded once
+# and the trackers run in parallel. Results are written as one row per -R value in sweep.txt:
+# -R frames tracked seconds, then median/mean/max of the global, x, y, z, wx, wy, wz variances
+# and of the number of iterations model initialisation needed (capped by -S)
+./tracking_sweep -c "/home/fnovotny/playground/flashcode_mbt/data/config.cfg" -v 1 -D ../flashcode_mbt/data/ -S 5 --convergence-threshold 0.0005 0.005 -r zbar --sweep R=1:20:1 --sweep-output sweep.txt
 
-for j in {1..20}
+names=( "median" "mean" "max" )
+echo "#start of file" > plot.dat
+for k in 0 1 2
 do
-    ./tracking -c "/home/fnovotny/playground/flashcode_mbt/data/config.cfg" -v -D ../flashcode_mbt/data/ -S 5 -r zbar -R $j > out.log
-    names=( "median" "mean" "max" )
-    for name in ${names[@]}
+    name=${names[$k]}
+    plot="plot "
+    for g in 0 1 2 3 4 5 6
     do
-	echo $name
-	i=0
-	for medianline in $(cat out.log | grep $name)
-	do
-	    medianlines[$i]=${medianline:`expr ${#name}+1`}
-	    i=`expr $i + 1`
-	done
-	echo "$j ${medianlines[0]} ${medianlines[1]} ${medianlines[2]} ${medianlines[3]} ${medianlines[4]} ${medianlines[5]} ${medianlines[6]}" >> $name.txt
+	column=`expr 5 + 3 \* $g + $k`
+	plot="$plot\"sweep.txt\" using 1:$column with lines,"
     done
-
+    echo "${plot%,}" >> plot.dat
 done
-
-echo "#start of file" > plot.dat
-for name in ${names[@]}
-do
-    echo $name    
-    echo 'plot \"$name.txt\" using 1:2 with lines title,\"$name.txt\" using 1:3 with lines,\"$name.txt\" using 1:4 with lines,\"$name.txt\" using 1:5 with lines,\"$name.txt\" using 1:6 with lines,\"$name.txt\" using 1:7 with lines,\"$name.txt\" using 1:8 with lines' >> plot.dat
-done
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "source.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <visp/vpImageIo.h>
+#include <visp/vpException.h>
+
+namespace sources{
+namespace prefetch{
+  Source::Source(const std::string& pattern, long first, unsigned int depth, unsigned int workers, double frame_rate) :
+      pattern_(pattern),
+      first_(first),
+      last_(first-1),
+      period_(1000./frame_rate),
+      slots_(std::max(depth,1u)),
+      next_to_decode_(first),
+      next_to_deliver_(first),
+      timestamp_(0.),
+      stop_(false){
+    while(std::ifstream(filename(last_+1).c_str()).good())
+      last_++;
+    if(last_ < first_)
+      throw std::runtime_error("no image matching " + pattern);
+
+    for(unsigned int i=0;i<slots_.size();i++)
+      slots_[i].state = SLOT_EMPTY;
+    if(workers == 0)
+      workers = std::max(boost::thread::hardware_concurrency(),1u);
+    for(unsigned int i=0;i<workers;i++)
+      workers_.create_thread(boost::bind(&Source::decode,this));
+  }
+
+  Source::~Source(){
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      stop_ = true;
+    }
+    slot_freed_.notify_all();
+    workers_.join_all();
+  }
+
+  std::string Source::filename(long index) const{
+    char name[FILENAME_MAX];
+    snprintf(name,sizeof(name),pattern_.c_str(),index);
+    return std::string(name);
+  }
+
+  Source::slot_t& Source::slot(long index){
+    return slots_[(index - first_) % slots_.size()];
+  }
+
+  void Source::decode(){
+    boost::mutex::scoped_lock lock(mutex_);
+    for(;;){
+      while(!stop_ && (next_to_decode_ > last_ || slot(next_to_decode_).state != SLOT_EMPTY))
+        slot_freed_.wait(lock);
+      if(stop_)
+        return;
+
+      long index = next_to_decode_++;
+      slot_t& s = slot(index);
+      s.state = SLOT_DECODING;
+      lock.unlock();
+      slot_state_t state = SLOT_READY;
+      try{
+        vpImageIo::read(s.image,filename(index)); //reuses the slot buffer when the size does not change
+      }catch(vpException& e){
+        state = SLOT_FAILED;
+      }
+      lock.lock();
+      s.state = state;
+      slot_ready_.notify_all();
+    }
+  }
+
+  void Source::open(vpImage<vpRGBa>& I){
+    vpImageIo::read(I,filename(first_));
+  }
+
+  bool Source::acquire(vpImage<vpRGBa>& I){
+    boost::mutex::scoped_lock lock(mutex_);
+    if(next_to_deliver_ > last_)
+      return false;
+    slot_t& s = slot(next_to_deliver_);
+    while(s.state != SLOT_READY && s.state != SLOT_FAILED)
+      slot_ready_.wait(lock);
+    if(s.state == SLOT_FAILED)
+      return false;
+    lock.unlock();
+    I = s.image; //the slot stays reserved until the copy is done
+    lock.lock();
+    s.state = SLOT_EMPTY;
+    timestamp_ = (next_to_deliver_ - first_)*period_;
+    next_to_deliver_++;
+    slot_freed_.notify_all();
+    return true;
+  }
+
+  double Source::get_timestamp() const{
+    return timestamp_;
+  }
+
+  long Source::get_first_frame_index() const{
+    return first_;
+  }
+
+  long Source::get_last_frame_index() const{
+    return last_;
+  }
+}
+}
@@ -0,0 +1,60 @@
+#ifndef __PREFETCH_SOURCE_H__
+#define __PREFETCH_SOURCE_H__
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+#include "source_base.h"
+
+namespace sources{
+namespace prefetch{
+  /*
+   * Reads an image sequence (printf-like pattern, as vpVideoReader) ahead of the tracker.
+   * A pool of workers decodes the next frames into a ring of recycled buffers. Frames are delivered in order.
+   */
+  class Source : public SourceBase{
+  private:
+    enum slot_state_t{ SLOT_EMPTY, SLOT_DECODING, SLOT_READY, SLOT_FAILED };
+    struct slot_t{
+      vpImage<vpRGBa> image;
+      slot_state_t state;
+    };
+    std::string pattern_;
+    long first_;
+    long last_;
+    double period_;
+    std::vector<slot_t> slots_;
+    long next_to_decode_;
+    long next_to_deliver_;
+    double timestamp_;
+    bool stop_;
+    boost::mutex mutex_;
+    boost::condition_variable slot_freed_;
+    boost::condition_variable slot_ready_;
+    boost::thread_group workers_;
+
+    std::string filename(long index) const;
+    slot_t& slot(long index);
+    void decode();
+  public:
+    /*
+     * pattern: image file pattern, for example /data/images/%08d.jpg
+     * first: index of the first frame. The sequence ends at the first missing file
+     * depth: number of frames decoded ahead of the tracker
+     * workers: number of decoding threads, 0 for one per core
+     * frame_rate: used to timestamp frames
+     * */
+    Source(const std::string& pattern, long first, unsigned int depth, unsigned int workers, double frame_rate);
+    ~Source();
+    void open(vpImage<vpRGBa>& I);
+    //blocks until the next frame is decoded. Returns false at the end of the sequence or on a decoding error
+    bool acquire(vpImage<vpRGBa>& I);
+    double get_timestamp() const;
+    long get_first_frame_index() const;
+    long get_last_frame_index() const;
+  };
+}
+}
+#endif
@@ -0,0 +1,39 @@
+#ifndef __RAW_FORMAT_H__
+#define __RAW_FORMAT_H__
+#include <boost/cstdint.hpp>
+
+/*
+ * Layout of a raw frame container:
+ *  header_t
+ *  frame data, each frame starting on a FRAME_ALIGNMENT boundary
+ *  index_entry_t[frame_count] at header_t::index_offset
+ * All values are stored in host byte order.
+ */
+namespace sources{
+namespace raw{
+  enum pixel_format_t{
+    FORMAT_GRAY = 1, //one byte per pixel
+    FORMAT_RGBA = 4  //vpRGBa, four bytes per pixel
+  };
+
+  static const char MAGIC[8] = {'F','C','R','A','W','F','R','M'};
+  static const boost::uint32_t VERSION = 1;
+  static const boost::uint64_t FRAME_ALIGNMENT = 64;
+
+  struct header_t{
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t format;
+    boost::uint32_t width;
+    boost::uint32_t height;
+    boost::uint64_t frame_count;
+    boost::uint64_t index_offset;
+  };
+
+  struct index_entry_t{
+    boost::uint64_t offset;
+    double timestamp; //ms
+  };
+}
+}
+#endif
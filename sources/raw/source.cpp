@@ -0,0 +1,130 @@
+#include "source.h"
+#include <cstring>
+#include <stdexcept>
+#include <visp/vpImageConvert.h>
+#include "imgconv/convert.h"
+
+namespace sources{
+namespace raw{
+  Source::Source(const std::string& path) :
+      file_(path.c_str(),boost::interprocess::read_only),
+      region_(file_,boost::interprocess::copy_on_write),
+      next_(0),
+      last_(0),
+      timestamp_(0.){
+    if(region_.get_size() < sizeof(header_t))
+      throw std::runtime_error("raw container too small: " + path);
+    header_ = static_cast<const header_t*>(region_.get_address());
+    if(std::memcmp(header_->magic,MAGIC,sizeof(MAGIC)) != 0 || header_->version != VERSION)
+      throw std::runtime_error("not a raw frame container: " + path);
+    if(header_->index_offset > region_.get_size()
+       || header_->frame_count > (region_.get_size() - header_->index_offset)/sizeof(index_entry_t))
+      throw std::runtime_error("truncated raw container: " + path);
+    index_ = reinterpret_cast<const index_entry_t*>(static_cast<const char*>(region_.get_address()) + header_->index_offset);
+    //frames are handed out as views on the mapping, each one must lie inside it
+    if(header_->format != FORMAT_GRAY && header_->format != FORMAT_RGBA)
+      throw std::runtime_error("unknown pixel format in raw container: " + path);
+    boost::uint64_t frame_size = (boost::uint64_t)header_->width*header_->height*header_->format;
+    for(boost::uint64_t i=0;i<header_->frame_count;i++)
+      if(index_[i].offset < sizeof(header_t) || index_[i].offset > region_.get_size() || frame_size > region_.get_size() - index_[i].offset)
+        throw std::runtime_error("truncated raw container: " + path);
+  }
+
+  unsigned char* Source::frame_data(unsigned int i) const{
+    if(i >= header_->frame_count)
+      throw std::out_of_range("raw container frame index");
+    return static_cast<unsigned char*>(region_.get_address()) + index_[i].offset;
+  }
+
+  void Source::view(unsigned int i, vpImage<vpRGBa>& I){
+    if(header_->format != FORMAT_RGBA)
+      throw std::runtime_error("raw container does not hold RGBA frames");
+    I.init(reinterpret_cast<vpRGBa*>(frame_data(i)),header_->height,header_->width,false);
+  }
+
+  void Source::view(unsigned int i, vpImage<unsigned char>& I){
+    if(header_->format != FORMAT_GRAY)
+      throw std::runtime_error("raw container does not hold gray frames");
+    I.init(frame_data(i),header_->height,header_->width,false);
+  }
+
+  void Source::open(vpImage<vpRGBa>& I){
+    if(next_ >= header_->frame_count){
+      I.resize(header_->height,header_->width);
+      return;
+    }
+    last_ = next_;
+    rgba(I);
+  }
+
+  bool Source::acquire(vpImage<vpRGBa>& I){
+    if(next_ >= header_->frame_count)
+      return false;
+    last_ = next_;
+    rgba(I);
+    timestamp_ = index_[next_].timestamp;
+    next_++;
+    return true;
+  }
+
+  bool Source::acquire(vpImage<unsigned char>& Y){
+    if(next_ >= header_->frame_count)
+      return false;
+    last_ = next_;
+    if(header_->format == FORMAT_GRAY)
+      view(next_,Y);
+    else{
+      unsigned int width = header_->width, height = header_->height;
+      if(Y.getWidth()!=width || Y.getHeight()!=height)
+        Y.resize(height,width);
+      const unsigned char* frame = frame_data(next_);
+      for(unsigned int v=0;v<height;v++)
+        imgconv::rgba_to_gray(frame+(std::size_t)v*width*4,Y[v],width);
+    }
+    timestamp_ = index_[next_].timestamp;
+    next_++;
+    return true;
+  }
+
+  void Source::rgba(vpImage<vpRGBa>& I){
+    if(header_->format == FORMAT_RGBA){
+      view(last_,I);
+      return;
+    }
+    unsigned int width = header_->width, height = header_->height;
+    if(I.getWidth()!=width || I.getHeight()!=height)
+      I.resize(height,width);
+    unsigned char* frame = frame_data(last_);
+    for(unsigned int v=0;v<height;v++)
+      vpImageConvert::GreyToRGBa(frame+(std::size_t)v*width,reinterpret_cast<unsigned char*>(I[v]),width);
+  }
+
+  double Source::get_timestamp() const{
+    return timestamp_;
+  }
+
+  double Source::get_timestamp(unsigned int i) const{
+    return index_[i].timestamp;
+  }
+
+  unsigned int Source::get_frame_count() const{
+    return (unsigned int)header_->frame_count;
+  }
+
+  unsigned int Source::get_width() const{
+    return header_->width;
+  }
+
+  unsigned int Source::get_height() const{
+    return header_->height;
+  }
+
+  pixel_format_t Source::get_format() const{
+    return (pixel_format_t)header_->format;
+  }
+
+  void Source::seek(unsigned int i){
+    next_ = i;
+  }
+}
+}
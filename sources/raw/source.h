@@ -0,0 +1,55 @@
+#ifndef __RAW_SOURCE_H__
+#define __RAW_SOURCE_H__
+#include <string>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+#include "source_base.h"
+#include "format.h"
+
+namespace sources{
+namespace raw{
+  /*
+   * Replays a raw frame container written by raw::Writer.
+   * The file is memory mapped copy-on-write: frames are handed out as views on the mapping,
+   * no decode nor copy happens and writes to a view never reach the file.
+   * Views stay valid as long as the source is alive.
+   * Gray containers hand the tracker their frames through acquire(Y), RGBA is only built by rgba() for display or recording.
+   */
+  class Source : public LumaSourceBase{
+  private:
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    const header_t* header_;
+    const index_entry_t* index_;
+    unsigned int next_;
+    unsigned int last_; //last acquired frame, converted by rgba()
+    double timestamp_;
+    unsigned char* frame_data(unsigned int i) const;
+  public:
+    //throws std::runtime_error if the file is not a valid container
+    Source(const std::string& path);
+    //points I to frame i. The container must hold RGBA frames
+    void view(unsigned int i, vpImage<vpRGBa>& I);
+    //points I to frame i. The container must hold gray frames
+    void view(unsigned int i, vpImage<unsigned char>& I);
+    void open(vpImage<vpRGBa>& I);
+    //a view on RGBA containers, converted from gray ones
+    bool acquire(vpImage<vpRGBa>& I);
+    //a view on gray containers, converted from RGBA ones
+    bool acquire(vpImage<unsigned char>& Y);
+    void rgba(vpImage<vpRGBa>& I);
+    double get_timestamp() const;
+    double get_timestamp(unsigned int i) const;
+    unsigned int get_frame_count() const;
+    unsigned int get_width() const;
+    unsigned int get_height() const;
+    pixel_format_t get_format() const;
+    //restarts acquisition from frame i
+    void seek(unsigned int i);
+  };
+}
+}
+#endif
@@ -0,0 +1,84 @@
+#include "writer.h"
+#include <cstring>
+#include <stdexcept>
+#include <visp/vpImageConvert.h>
+#include "imgconv/convert.h"
+
+namespace sources{
+namespace raw{
+  Writer::Writer(const std::string& path, pixel_format_t format) :
+      file_(path.c_str(),std::ios::out | std::ios::binary | std::ios::trunc){
+    if(!file_)
+      throw std::runtime_error("could not create raw container: " + path);
+    std::memset(&header_,0,sizeof(header_));
+    std::memcpy(header_.magic,MAGIC,sizeof(MAGIC));
+    header_.version = VERSION;
+    header_.format = format;
+    //the header is rewritten with the final counts by close()
+    file_.write(reinterpret_cast<const char*>(&header_),sizeof(header_));
+  }
+
+  Writer::~Writer(){
+    if(file_.is_open())
+      close();
+  }
+
+  void Writer::pad(){
+    static const char zeros[FRAME_ALIGNMENT] = {0};
+    boost::uint64_t pos = (boost::uint64_t)file_.tellp();
+    boost::uint64_t rem = pos % FRAME_ALIGNMENT;
+    if(rem)
+      file_.write(zeros,FRAME_ALIGNMENT - rem);
+  }
+
+  void Writer::write_frame(const unsigned char* data, unsigned int width, unsigned int height, double timestamp){
+    if(index_.empty()){
+      header_.width = width;
+      header_.height = height;
+    }else if(width != header_.width || height != header_.height)
+      throw std::runtime_error("raw container frames must all have the same size");
+
+    pad();
+    index_entry_t entry;
+    entry.offset = (boost::uint64_t)file_.tellp();
+    entry.timestamp = timestamp;
+    file_.write(reinterpret_cast<const char*>(data),(std::streamsize)width*height*header_.format);
+    if(!file_)
+      throw std::runtime_error("could not write raw container frame");
+    index_.push_back(entry);
+  }
+
+  void Writer::write(const vpImage<vpRGBa>& I, double timestamp){
+    if(header_.format == FORMAT_RGBA){
+      write_frame(reinterpret_cast<const unsigned char*>(I.bitmap),I.getWidth(),I.getHeight(),timestamp);
+    }else{
+      imgconv::convert(I,gray_);
+      write_frame(gray_.bitmap,gray_.getWidth(),gray_.getHeight(),timestamp);
+    }
+  }
+
+  void Writer::write(const vpImage<unsigned char>& I, double timestamp){
+    if(header_.format == FORMAT_GRAY){
+      write_frame(I.bitmap,I.getWidth(),I.getHeight(),timestamp);
+    }else{
+      vpImageConvert::convert(I,rgba_);
+      write_frame(reinterpret_cast<const unsigned char*>(rgba_.bitmap),rgba_.getWidth(),rgba_.getHeight(),timestamp);
+    }
+  }
+
+  unsigned int Writer::get_frame_count() const{
+    return (unsigned int)index_.size();
+  }
+
+  void Writer::close(){
+    pad();
+    header_.frame_count = index_.size();
+    header_.index_offset = (boost::uint64_t)file_.tellp();
+    if(!index_.empty())
+      file_.write(reinterpret_cast<const char*>(&index_[0]),index_.size()*sizeof(index_entry_t));
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header_),sizeof(header_));
+    file_.close();
+  }
+}
+}
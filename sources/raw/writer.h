@@ -0,0 +1,39 @@
+#ifndef __RAW_WRITER_H__
+#define __RAW_WRITER_H__
+#include <string>
+#include <vector>
+#include <fstream>
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+#include "format.h"
+
+namespace sources{
+namespace raw{
+  /*
+   * Writes a raw frame container readable by raw::Source.
+   * All frames must share the size of the first one.
+   * The index is written by close(), which the destructor calls if needed.
+   */
+  class Writer{
+  private:
+    std::ofstream file_;
+    header_t header_;
+    std::vector<index_entry_t> index_;
+    vpImage<unsigned char> gray_;
+    vpImage<vpRGBa> rgba_;
+    void write_frame(const unsigned char* data, unsigned int width, unsigned int height, double timestamp);
+    void pad();
+  public:
+    //throws std::runtime_error if the file cannot be created
+    Writer(const std::string& path, pixel_format_t format);
+    ~Writer();
+    //appends a frame, converting it to the container format if needed
+    void write(const vpImage<vpRGBa>& I, double timestamp);
+    void write(const vpImage<unsigned char>& I, double timestamp);
+    unsigned int get_frame_count() const;
+    void close();
+  };
+}
+}
+#endif
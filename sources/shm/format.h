@@ -0,0 +1,62 @@
+#ifndef __SHM_FORMAT_H__
+#define __SHM_FORMAT_H__
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+
+/*
+ * Layout of a shared memory frame ring:
+ *  ring_header_t
+ *  slot_count slots of slot_size bytes from slots_offset, each one a slot_header_t then the frame rows
+ *  SLOT_ALIGNMENT bytes after the start of the slot
+ * Slots and frame data start on SLOT_ALIGNMENT boundaries. All values are stored in host byte order.
+ *
+ * The producer fills a slot that is neither the one the reader holds nor the latest published one,
+ * then publishes it: slot seq, latest, head, and finally a bump of the futex word readers sleep on.
+ * A slot seq is 0 while the slot is written, so a reader checks the seq of the slot it took against head.
+ */
+namespace sources{
+namespace shm{
+  enum pixel_format_t{
+    FORMAT_GRAY = 1, //one byte per pixel
+    FORMAT_YUYV = 2, //packed YUYV 4:2:2, two bytes per pixel
+    FORMAT_RGBA = 4  //vpRGBa, four bytes per pixel
+  };
+
+  static const char MAGIC[8] = {'F','C','S','H','M','R','N','G'};
+  static const boost::uint32_t VERSION = 1;
+  static const boost::uint64_t SLOT_ALIGNMENT = 64;
+  static const boost::uint32_t MIN_SLOTS = 3;
+  static const boost::uint32_t NO_SLOT = 0xFFFFFFFF;
+
+  struct ring_header_t{
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t slot_count;
+    boost::uint32_t width;
+    boost::uint32_t height;
+    boost::uint32_t format;
+    boost::uint32_t stride;       //bytes from one row to the next
+    boost::uint64_t slot_size;
+    boost::uint64_t slots_offset;
+    //written by the producer
+    boost::uint64_t head;         //seq of the last published frame, 0 before the first one
+    boost::uint32_t latest;       //slot holding head
+    boost::uint32_t futex;        //bumped at each publication and when closing
+    boost::uint32_t closed;       //set when the producer stops
+    //written by the reader
+    boost::uint32_t held;         //slot the reader is viewing, NO_SLOT when none
+    boost::uint32_t waiters;      //readers sleeping on futex
+  };
+
+  struct slot_header_t{
+    boost::uint64_t seq;          //frame held by the slot, 0 while it is written
+    double timestamp;             //ms
+    boost::uint32_t format;
+    boost::uint32_t width;
+    boost::uint32_t height;
+    boost::uint32_t stride;
+  };
+  BOOST_STATIC_ASSERT(sizeof(slot_header_t) <= SLOT_ALIGNMENT);
+}
+}
+#endif
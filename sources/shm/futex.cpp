@@ -0,0 +1,47 @@
+#include "futex.h"
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <boost/thread/thread.hpp>
+#include <visp/vpTime.h>
+#endif
+
+namespace sources{
+namespace shm{
+#ifdef __linux__
+  //shared futexes (no FUTEX_PRIVATE_FLAG): the word lives in memory mapped by several processes
+  bool futex_wait(boost::uint32_t& word, boost::uint32_t seen, unsigned int timeout){
+    struct timespec delay;
+    delay.tv_sec = timeout/1000;
+    delay.tv_nsec = (long)(timeout%1000)*1000000L;
+    if(syscall(SYS_futex,&word,FUTEX_WAIT,seen,&delay,NULL,0)==0)
+      return true;
+    //EAGAIN: the word changed before sleeping, EINTR: woken by a signal
+    return errno!=ETIMEDOUT;
+  }
+
+  void futex_wake(boost::uint32_t& word){
+    syscall(SYS_futex,&word,FUTEX_WAKE,INT_MAX,NULL,NULL,0);
+  }
+#else
+  //without futexes the reader polls the word every millisecond
+  bool futex_wait(boost::uint32_t& word, boost::uint32_t seen, unsigned int timeout){
+    double deadline = vpTime::measureTimeMs() + timeout;
+    while(load(word)==seen){
+      if(vpTime::measureTimeMs()>=deadline)
+        return false;
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    return true;
+  }
+
+  void futex_wake(boost::uint32_t&){
+  }
+#endif
+}
+}
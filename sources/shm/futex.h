@@ -0,0 +1,30 @@
+#ifndef __SHM_FUTEX_H__
+#define __SHM_FUTEX_H__
+#include <boost/cstdint.hpp>
+
+/*
+ * Synchronisation on words of a memory region shared between processes.
+ * Loads and stores are sequentially consistent so that the producer and the reader always see
+ * each other's slot claims (see format.h).
+ */
+namespace sources{
+namespace shm{
+  template<class T> inline T load(const T& word){
+    return __atomic_load_n(&word,__ATOMIC_SEQ_CST);
+  }
+
+  template<class T> inline void store(T& word, T value){
+    __atomic_store_n(&word,value,__ATOMIC_SEQ_CST);
+  }
+
+  template<class T> inline T add(T& word, T value){
+    return __atomic_add_fetch(&word,value,__ATOMIC_SEQ_CST);
+  }
+
+  //sleeps while word holds seen, at most timeout ms. Returns false on timeout
+  bool futex_wait(boost::uint32_t& word, boost::uint32_t seen, unsigned int timeout);
+  //wakes every process sleeping on word
+  void futex_wake(boost::uint32_t& word);
+}
+}
+#endif
@@ -0,0 +1,186 @@
+#include "source.h"
+#include <cstring>
+#include <stdexcept>
+#include <visp/vpImageConvert.h>
+#include <visp/vpTime.h>
+#include "imgconv/convert.h"
+#include "futex.h"
+
+namespace sources{
+namespace shm{
+  Source::Source(const std::string& name, unsigned int timeout) :
+      shm_(boost::interprocess::open_only,name.c_str(),boost::interprocess::read_write),
+      region_(shm_,boost::interprocess::read_write),
+      slot_(NULL),
+      seq_(0),
+      timeout_(timeout),
+      timestamp_(0.),
+      acquired_(0),
+      dropped_(0){
+    if(region_.get_size() < sizeof(ring_header_t))
+      throw std::runtime_error("shared memory ring too small: " + name);
+    header_ = static_cast<ring_header_t*>(region_.get_address());
+    if(std::memcmp(header_->magic,MAGIC,sizeof(MAGIC)) != 0 || header_->version != VERSION)
+      throw std::runtime_error("not a shared memory frame ring: " + name);
+    //the geometry comes from another process, every slot view must stay inside the mapping
+    geometry_ = *header_;
+    const ring_header_t& h = geometry_;
+    if(h.format != FORMAT_GRAY && h.format != FORMAT_YUYV && h.format != FORMAT_RGBA)
+      throw std::runtime_error("unknown pixel format in shared memory ring: " + name);
+    if(h.width == 0 || h.height == 0 || h.stride < (boost::uint64_t)h.width*h.format)
+      throw std::runtime_error("invalid frame geometry in shared memory ring: " + name);
+    if(h.slot_size < SLOT_ALIGNMENT || (boost::uint64_t)h.stride*h.height > h.slot_size - SLOT_ALIGNMENT)
+      throw std::runtime_error("shared memory ring slots too small for their frames: " + name);
+    boost::uint64_t size = region_.get_size();
+    if(h.slot_count < MIN_SLOTS || h.slots_offset < sizeof(ring_header_t) || h.slots_offset > size
+       || h.slot_count > (size - h.slots_offset)/h.slot_size)
+      throw std::runtime_error("truncated shared memory ring: " + name);
+  }
+
+  bool Source::consistent(const slot_header_t* slot) const{
+    return slot->format == geometry_.format && slot->width == geometry_.width
+        && slot->height == geometry_.height && slot->stride == geometry_.stride;
+  }
+
+  Source::~Source(){
+    store(header_->held,NO_SLOT);
+  }
+
+  slot_header_t* Source::get_slot(unsigned int i) const{
+    return reinterpret_cast<slot_header_t*>(static_cast<char*>(region_.get_address()) + geometry_.slots_offset + i*geometry_.slot_size);
+  }
+
+  const unsigned char* Source::row(unsigned int v) const{
+    return reinterpret_cast<const unsigned char*>(slot_) + SLOT_ALIGNMENT + (std::size_t)v*geometry_.stride;
+  }
+
+  bool Source::packed() const{
+    return geometry_.stride == geometry_.width*geometry_.format;
+  }
+
+  bool Source::next(){
+    double deadline = vpTime::measureTimeMs() + timeout_;
+    for(;;){
+      boost::uint32_t seen = load(header_->futex);
+      boost::uint64_t head = load(header_->head);
+      if(head > seq_){
+        unsigned int i = load(header_->latest);
+        slot_header_t* slot = NULL;
+        if(i < geometry_.slot_count){
+          //claim the slot first, then check the producer did not start overwriting it
+          store(header_->held,(boost::uint32_t)i);
+          slot = get_slot(i);
+          if(load(slot->seq) != head)
+            continue;
+        }
+        if(seq_)
+          dropped_ += (unsigned long)(head - seq_ - 1);
+        seq_ = head;
+        if(!slot || !consistent(slot)){
+          //a frame that does not match the ring geometry is dropped, the next one may be fine
+          dropped_++;
+          continue;
+        }
+        slot_ = slot;
+        timestamp_ = slot->timestamp;
+        acquired_++;
+        return true;
+      }
+      if(load(header_->closed))
+        return false;
+      double remaining = deadline - vpTime::measureTimeMs();
+      if(remaining <= 0.)
+        return false;
+      add(header_->waiters,1u);
+      futex_wait(header_->futex,seen,(unsigned int)remaining+1);
+      add(header_->waiters,(boost::uint32_t)-1);
+    }
+  }
+
+  void Source::open(vpImage<vpRGBa>& I){
+    I.resize(geometry_.height,geometry_.width);
+  }
+
+  bool Source::acquire(vpImage<vpRGBa>& I){
+    if(!next())
+      return false;
+    if(geometry_.format == FORMAT_RGBA && packed())
+      I.init(reinterpret_cast<vpRGBa*>(const_cast<unsigned char*>(row(0))),geometry_.height,geometry_.width,false);
+    else
+      rgba(I);
+    return true;
+  }
+
+  bool Source::acquire(vpImage<unsigned char>& Y){
+    if(!next())
+      return false;
+    unsigned int width = geometry_.width, height = geometry_.height;
+    if(geometry_.format == FORMAT_GRAY && packed()){
+      Y.init(const_cast<unsigned char*>(row(0)),height,width,false);
+      return true;
+    }
+    if(Y.getWidth()!=width || Y.getHeight()!=height)
+      Y.resize(height,width);
+    for(unsigned int v=0;v<height;v++){
+      switch(geometry_.format){
+        case FORMAT_GRAY:
+          std::memcpy(Y[v],row(v),width);
+          break;
+        case FORMAT_YUYV:
+          imgconv::yuyv_to_gray(row(v),Y[v],width);
+          break;
+        case FORMAT_RGBA:
+          imgconv::rgba_to_gray(row(v),Y[v],width);
+          break;
+      }
+    }
+    return true;
+  }
+
+  void Source::rgba(vpImage<vpRGBa>& I){
+    if(!slot_)
+      return;
+    unsigned int width = geometry_.width, height = geometry_.height;
+    if(I.getWidth()!=width || I.getHeight()!=height)
+      I.resize(height,width);
+    for(unsigned int v=0;v<height;v++){
+      unsigned char* dst = reinterpret_cast<unsigned char*>(I[v]);
+      switch(geometry_.format){
+        case FORMAT_GRAY:
+          vpImageConvert::GreyToRGBa(const_cast<unsigned char*>(row(v)),dst,width);
+          break;
+        case FORMAT_YUYV:
+          vpImageConvert::YUYVToRGBa(const_cast<unsigned char*>(row(v)),dst,width,1);
+          break;
+        case FORMAT_RGBA:
+          std::memcpy(dst,row(v),(std::size_t)width*4);
+          break;
+      }
+    }
+  }
+
+  double Source::get_timestamp() const{
+    return timestamp_;
+  }
+
+  unsigned int Source::get_width() const{
+    return geometry_.width;
+  }
+
+  unsigned int Source::get_height() const{
+    return geometry_.height;
+  }
+
+  pixel_format_t Source::get_format() const{
+    return (pixel_format_t)geometry_.format;
+  }
+
+  unsigned long Source::get_acquired() const{
+    return acquired_;
+  }
+
+  unsigned long Source::get_dropped() const{
+    return dropped_;
+  }
+}
+}
@@ -0,0 +1,66 @@
+#ifndef __SHM_SOURCE_H__
+#define __SHM_SOURCE_H__
+#include <string>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+#include "source_base.h"
+#include "format.h"
+
+namespace sources{
+namespace shm{
+  /*
+   * Attaches to a shared memory frame ring written by another process (see shm::Writer and shm_producer).
+   * Each acquire takes the latest published frame, older ones are dropped as a camera would.
+   * The slot of the acquired frame is held until the next acquire: packed gray and RGBA frames are handed out
+   * as views on the slot, with no copy. Luminance of YUYV frames is extracted into a buffer of the source.
+   * The reader sleeps on a futex until the producer publishes, the stream ends when the producer closes the ring
+   * or nothing is published for timeout ms.
+   */
+  class Source : public LumaSourceBase{
+  private:
+    boost::interprocess::shared_memory_object shm_;
+    boost::interprocess::mapped_region region_;
+    ring_header_t* header_;
+    ring_header_t geometry_;    //validated copy of the ring header, the producer may still write the shared one
+    const slot_header_t* slot_; //held slot, NULL before the first frame
+    boost::uint64_t seq_;
+    unsigned int timeout_;
+    double timestamp_;
+    unsigned long acquired_,dropped_;
+    Source(const Source&);
+    Source& operator=(const Source&);
+    slot_header_t* get_slot(unsigned int i) const;
+    const unsigned char* row(unsigned int v) const;
+    bool packed() const;
+    //true when the slot header agrees with the ring header
+    bool consistent(const slot_header_t* slot) const;
+    //waits for a frame newer than the last one and holds its slot
+    bool next();
+  public:
+    //throws boost::interprocess::interprocess_exception if there is no ring of that name,
+    //std::runtime_error if it is not a valid ring or its geometry does not fit the shared memory.
+    //Frames whose slot header disagrees with the ring header are dropped
+    Source(const std::string& name, unsigned int timeout);
+    ~Source();
+    //sizes I, no frame is consumed
+    void open(vpImage<vpRGBa>& I);
+    //RGBA rings give a view on the slot, gray and yuyv ones are converted
+    bool acquire(vpImage<vpRGBa>& I);
+    //gray rings give a view on the slot, yuyv and RGBA ones are converted
+    bool acquire(vpImage<unsigned char>& Y);
+    void rgba(vpImage<vpRGBa>& I);
+    double get_timestamp() const;
+    unsigned int get_width() const;
+    unsigned int get_height() const;
+    pixel_format_t get_format() const;
+
+    //metrics: frames acquired, and frames published after the first acquired one but never acquired
+    unsigned long get_acquired() const;
+    unsigned long get_dropped() const;
+  };
+}
+}
+#endif
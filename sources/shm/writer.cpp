@@ -0,0 +1,145 @@
+#include "writer.h"
+#include <cstring>
+#include <stdexcept>
+#include "imgconv/convert.h"
+#include "futex.h"
+
+namespace sources{
+namespace shm{
+  static boost::uint64_t align(boost::uint64_t size){
+    return (size + SLOT_ALIGNMENT - 1)/SLOT_ALIGNMENT*SLOT_ALIGNMENT;
+  }
+
+  //one row of RGBA to YUYV with the BT.601 integer approximation, chroma averaged over pixel pairs
+  static void rgba_to_yuyv(const unsigned char* rgba, unsigned char* yuyv, unsigned int width){
+    for(unsigned int u=0;u+1<width;u+=2,rgba+=8,yuyv+=4){
+      int r = (rgba[0]+rgba[4])/2, g = (rgba[1]+rgba[5])/2, b = (rgba[2]+rgba[6])/2;
+      yuyv[0] = (unsigned char)((( 66*rgba[0] + 129*rgba[1] +  25*rgba[2] + 128)>>8) + 16);
+      yuyv[2] = (unsigned char)((( 66*rgba[4] + 129*rgba[5] +  25*rgba[6] + 128)>>8) + 16);
+      yuyv[1] = (unsigned char)(((-38*r - 74*g + 112*b + 128)>>8) + 128);
+      yuyv[3] = (unsigned char)(((112*r - 94*g - 18*b + 128)>>8) + 128);
+    }
+  }
+
+  Writer::Writer(const std::string& name, unsigned int width, unsigned int height, pixel_format_t format, unsigned int slot_count) :
+      name_(name),
+      writing_(NO_SLOT),
+      next_(0),
+      seq_(0){
+    if(slot_count < MIN_SLOTS)
+      throw std::runtime_error("a shared memory ring needs at least 3 slots");
+    if(format == FORMAT_YUYV && width%2)
+      throw std::runtime_error("YUYV frames must have an even width");
+    //a ring left by a previous producer may have another size, readers still attached to it keep their mapping
+    boost::interprocess::shared_memory_object::remove(name.c_str());
+    boost::interprocess::shared_memory_object shm(boost::interprocess::create_only,name.c_str(),boost::interprocess::read_write);
+    shm_.swap(shm);
+
+    boost::uint32_t stride = width*format;
+    boost::uint64_t slot_size = SLOT_ALIGNMENT + align((boost::uint64_t)stride*height),
+                    slots_offset = align(sizeof(ring_header_t));
+    shm_.truncate((boost::interprocess::offset_t)(slots_offset + slot_count*slot_size));
+    boost::interprocess::mapped_region region(shm_,boost::interprocess::read_write);
+    region_.swap(region);
+
+    //a new shared memory object is zero filled: no frame published, no slot held
+    header_ = static_cast<ring_header_t*>(region_.get_address());
+    header_->version = VERSION;
+    header_->slot_count = slot_count;
+    header_->width = width;
+    header_->height = height;
+    header_->format = format;
+    header_->stride = stride;
+    header_->slot_size = slot_size;
+    header_->slots_offset = slots_offset;
+    header_->held = NO_SLOT;
+    //the magic comes last, readers attaching meanwhile refuse the ring
+    std::memcpy(header_->magic,MAGIC,sizeof(MAGIC));
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  }
+
+  Writer::~Writer(){
+    if(!load(header_->closed))
+      close();
+    boost::interprocess::shared_memory_object::remove(name_.c_str());
+  }
+
+  slot_header_t* Writer::get_slot(unsigned int i) const{
+    return reinterpret_cast<slot_header_t*>(static_cast<char*>(region_.get_address()) + header_->slots_offset + i*header_->slot_size);
+  }
+
+  unsigned char* Writer::begin_frame(){
+    const unsigned int count = header_->slot_count;
+    for(;;){
+      //never the latest frame, which a reader may be about to take, nor the one it holds
+      unsigned int i = next_;
+      while((seq_ && i == header_->latest) || i == load(header_->held))
+        i = (i+1)%count;
+      next_ = (i+1)%count;
+      slot_header_t* slot = get_slot(i);
+      boost::uint64_t seq = slot->seq;
+      store(slot->seq,(boost::uint64_t)0);
+      //the reader claims before checking the seq, we clear the seq before checking the claim: one of us sees the other
+      if(load(header_->held) != i){
+        writing_ = i;
+        return reinterpret_cast<unsigned char*>(slot) + SLOT_ALIGNMENT;
+      }
+      store(slot->seq,seq);
+    }
+  }
+
+  void Writer::publish(double timestamp){
+    if(writing_ == NO_SLOT)
+      throw std::logic_error("shared memory ring: publish without begin_frame");
+    slot_header_t* slot = get_slot(writing_);
+    slot->timestamp = timestamp;
+    slot->format = header_->format;
+    slot->width = header_->width;
+    slot->height = header_->height;
+    slot->stride = header_->stride;
+    store(slot->seq,++seq_);
+    store(header_->latest,(boost::uint32_t)writing_);
+    store(header_->head,seq_);
+    writing_ = NO_SLOT;
+    add(header_->futex,1u);
+    //no system call while nobody sleeps
+    if(load(header_->waiters))
+      futex_wake(header_->futex);
+  }
+
+  void Writer::write(const vpImage<vpRGBa>& I, double timestamp){
+    if(I.getWidth() != header_->width || I.getHeight() != header_->height)
+      throw std::runtime_error("shared memory ring frames must all have the ring size");
+    unsigned char* data = begin_frame();
+    for(unsigned int v=0;v<header_->height;v++,data+=header_->stride){
+      const unsigned char* src = reinterpret_cast<const unsigned char*>(I[v]);
+      switch(header_->format){
+        case FORMAT_GRAY:
+          imgconv::rgba_to_gray(src,data,header_->width);
+          break;
+        case FORMAT_YUYV:
+          rgba_to_yuyv(src,data,header_->width);
+          break;
+        case FORMAT_RGBA:
+          std::memcpy(data,src,(std::size_t)header_->width*4);
+          break;
+      }
+    }
+    publish(timestamp);
+  }
+
+  unsigned int Writer::get_stride() const{
+    return header_->stride;
+  }
+
+  unsigned long Writer::get_frame_count() const{
+    return (unsigned long)seq_;
+  }
+
+  void Writer::close(){
+    store(header_->closed,1u);
+    add(header_->futex,1u);
+    futex_wake(header_->futex);
+  }
+}
+}
@@ -0,0 +1,48 @@
+#ifndef __SHM_WRITER_H__
+#define __SHM_WRITER_H__
+#include <string>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+#include "format.h"
+
+namespace sources{
+namespace shm{
+  /*
+   * Producer side of a shared memory frame ring read by shm::Source.
+   * Capture code can fill slots in place with begin_frame()/publish(), or hand RGBA images to write().
+   * Frames are published whether a reader is attached or not, a reader only ever gets the latest one.
+   * The ring is removed by the destructor, readers already attached keep their mapping.
+   */
+  class Writer{
+  private:
+    std::string name_;
+    boost::interprocess::shared_memory_object shm_;
+    boost::interprocess::mapped_region region_;
+    ring_header_t* header_;
+    unsigned int writing_; //slot being filled, NO_SLOT when none
+    unsigned int next_;    //first candidate for the next frame
+    boost::uint64_t seq_;
+    Writer(const Writer&);
+    Writer& operator=(const Writer&);
+    slot_header_t* get_slot(unsigned int i) const;
+  public:
+    //creates the ring, replacing any ring of the same name.
+    //throws std::runtime_error for fewer than MIN_SLOTS slots, boost::interprocess::interprocess_exception if it cannot be created
+    Writer(const std::string& name, unsigned int width, unsigned int height, pixel_format_t format, unsigned int slot_count);
+    ~Writer();
+    //returns the rows of a free slot, get_stride() bytes apart. The slot is not visible to readers until publish()
+    unsigned char* begin_frame();
+    void publish(double timestamp);
+    //publishes I converted to the ring format. I must have the ring size
+    void write(const vpImage<vpRGBa>& I, double timestamp);
+    unsigned int get_stride() const;
+    unsigned long get_frame_count() const;
+    //tells readers the stream is over
+    void close();
+  };
+}
+}
+#endif
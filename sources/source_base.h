@@ -0,0 +1,32 @@
+#ifndef __SOURCE_BASE_H__
+#define __SOURCE_BASE_H__
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+namespace sources{
+  class SourceBase{
+  public:
+    virtual ~SourceBase(){}
+    //loads the first frame into I without consuming it, so that displays can be sized
+    virtual void open(vpImage<vpRGBa>& I) = 0;
+    /*
+     * acquire the next frame
+     * I: image receiving the frame. Depending on the source it may be a view on memory owned by the source
+     * returns false when the stream is over
+     * */
+    virtual bool acquire(vpImage<vpRGBa>& I) = 0;
+    //returns the acquisition time of the last acquired frame in ms
+    virtual double get_timestamp() const = 0;
+  };
+
+  //sources able to hand the tracker luminance without going through RGBA
+  class LumaSourceBase : public SourceBase{
+  public:
+    using SourceBase::acquire;
+    //acquires the next frame, Y receives its luminance. Depending on the source it may be a view on memory owned by the source
+    virtual bool acquire(vpImage<unsigned char>& Y) = 0;
+    //converts the last acquired frame to RGBA, for display or recording
+    virtual void rgba(vpImage<vpRGBa>& I) = 0;
+  };
+}
+#endif
@@ -0,0 +1,31 @@
+#include "file_source.h"
+#include <stdexcept>
+#include <visp/vpTime.h>
+
+namespace sources{
+namespace yuyv{
+  FileSource::FileSource(const std::string& path, unsigned int width, unsigned int height, double frame_rate) :
+      Source(width,height),
+      file_(path.c_str(),boost::interprocess::read_only),
+      region_(file_,boost::interprocess::read_only),
+      next_(0),
+      frame_rate_(frame_rate),
+      start_(vpTime::measureTimeMs()){
+    std::size_t frame_size = (std::size_t)width*height*2;
+    if(frame_size==0 || region_.get_size()%frame_size != 0)
+      throw std::runtime_error("not a YUYV file of the given size: " + path);
+    frame_count_ = (unsigned int)(region_.get_size()/frame_size);
+  }
+
+  const unsigned char* FileSource::grab(){
+    if(next_>=frame_count_)
+      return NULL;
+    timestamp_ = start_ + next_*1000./frame_rate_;
+    return static_cast<const unsigned char*>(region_.get_address()) + (std::size_t)next_++*width_*height_*2;
+  }
+
+  unsigned int FileSource::get_frame_count() const{
+    return frame_count_;
+  }
+}
+}
@@ -0,0 +1,33 @@
+#ifndef __YUYV_FILE_SOURCE_H__
+#define __YUYV_FILE_SOURCE_H__
+#include <string>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "source.h"
+
+namespace sources{
+namespace yuyv{
+  /*
+   * Stand-in for a YUYV camera: replays a file of back to back YUYV frames of a known size,
+   * as dumped by a V4L2 capture (e.g. v4l2-ctl --stream-to).
+   * The file is memory mapped, frames are timestamped at the nominal frame rate.
+   */
+  class FileSource : public Source{
+  private:
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    unsigned int frame_count_;
+    unsigned int next_;
+    double frame_rate_;
+    double start_;
+  protected:
+    const unsigned char* grab();
+  public:
+    //throws std::runtime_error if the file does not hold a whole number of frames
+    FileSource(const std::string& path, unsigned int width, unsigned int height, double frame_rate);
+    unsigned int get_frame_count() const;
+  };
+}
+}
+#endif
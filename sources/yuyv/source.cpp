@@ -0,0 +1,57 @@
+#include "source.h"
+#include <visp/vpImageConvert.h>
+#include "imgconv/convert.h"
+
+namespace sources{
+namespace yuyv{
+  Source::Source(unsigned int width, unsigned int height) :
+      width_(width),
+      height_(height),
+      frame_(NULL),
+      timestamp_(0.){
+  }
+
+  void Source::extract_luma(const unsigned char* yuyv, unsigned int width, unsigned int height, vpImage<unsigned char>& Y){
+    imgconv::yuyv_to_gray(yuyv,width,height,Y);
+  }
+
+  bool Source::acquire(vpImage<unsigned char>& Y){
+    frame_ = grab();
+    if(!frame_)
+      return false;
+    extract_luma(frame_,width_,height_,Y);
+    return true;
+  }
+
+  void Source::rgba(vpImage<vpRGBa>& I){
+    if(I.getWidth()!=width_ || I.getHeight()!=height_)
+      I.resize(height_,width_);
+    if(frame_)
+      vpImageConvert::YUYVToRGBa(const_cast<unsigned char*>(frame_),(unsigned char*)I.bitmap,width_,height_);
+  }
+
+  void Source::open(vpImage<vpRGBa>& I){
+    I.resize(height_,width_);
+  }
+
+  bool Source::acquire(vpImage<vpRGBa>& I){
+    frame_ = grab();
+    if(!frame_)
+      return false;
+    rgba(I);
+    return true;
+  }
+
+  double Source::get_timestamp() const{
+    return timestamp_;
+  }
+
+  unsigned int Source::get_width() const{
+    return width_;
+  }
+
+  unsigned int Source::get_height() const{
+    return height_;
+  }
+}
+}
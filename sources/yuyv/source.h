@@ -0,0 +1,39 @@
+#ifndef __YUYV_SOURCE_H__
+#define __YUYV_SOURCE_H__
+#include <visp/vpImage.h>
+#include <visp/vpRGBa.h>
+
+#include "source_base.h"
+
+namespace sources{
+namespace yuyv{
+  /*
+   * Common part of sources delivering packed YUYV 4:2:2 frames.
+   * The tracker only needs luminance: acquire(vpImage<unsigned char>&) copies the Y samples of the frame
+   * and nothing else. RGBA is only computed on demand with rgba(), for display or recording.
+   */
+  class Source : public LumaSourceBase{
+  protected:
+    unsigned int width_,height_;
+    const unsigned char* frame_;
+    double timestamp_;
+    //returns the next YUYV frame, valid until the next call, or NULL when the stream is over. Sets timestamp_
+    virtual const unsigned char* grab() = 0;
+  public:
+    Source(unsigned int width, unsigned int height);
+    //copies the Y plane of a YUYV frame into Y
+    static void extract_luma(const unsigned char* yuyv, unsigned int width, unsigned int height, vpImage<unsigned char>& Y);
+    //acquires the next frame, Y receives its luminance
+    bool acquire(vpImage<unsigned char>& Y);
+    //converts the last acquired frame to RGBA
+    void rgba(vpImage<vpRGBa>& I);
+    //sizes I, no frame is consumed
+    void open(vpImage<vpRGBa>& I);
+    bool acquire(vpImage<vpRGBa>& I);
+    double get_timestamp() const;
+    unsigned int get_width() const;
+    unsigned int get_height() const;
+  };
+}
+}
+#endif
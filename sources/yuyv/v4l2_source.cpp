@@ -0,0 +1,120 @@
+#include "v4l2_source.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+namespace sources{
+namespace yuyv{
+  static int xioctl(int fd, unsigned long request, void* arg){
+    int r;
+    do{
+      r = ioctl(fd,request,arg);
+    }while(r==-1 && errno==EINTR);
+    return r;
+  }
+
+  V4l2Source::V4l2Source(const std::string& device, unsigned int width, unsigned int height, unsigned int nb_buffers) :
+      Source(width,height),
+      fd_(-1),
+      dequeued_(-1){
+    fd_ = ::open(device.c_str(),O_RDWR);
+    if(fd_<0)
+      throw std::runtime_error("cannot open video device " + device);
+
+    v4l2_format fmt;
+    std::memset(&fmt,0,sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = width;
+    fmt.fmt.pix.height = height;
+    fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if(xioctl(fd_,VIDIOC_S_FMT,&fmt)<0 || fmt.fmt.pix.pixelformat!=V4L2_PIX_FMT_YUYV
+       || fmt.fmt.pix.width!=width || fmt.fmt.pix.height!=height || fmt.fmt.pix.bytesperline!=width*2){
+      close();
+      throw std::runtime_error("video device " + device + " cannot stream packed YUYV at the requested size");
+    }
+
+    v4l2_requestbuffers req;
+    std::memset(&req,0,sizeof(req));
+    req.count = nb_buffers;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if(xioctl(fd_,VIDIOC_REQBUFS,&req)<0 || req.count<2){
+      close();
+      throw std::runtime_error("video device " + device + " does not support mmap streaming");
+    }
+
+    for(unsigned int i=0;i<req.count;i++){
+      v4l2_buffer buf;
+      std::memset(&buf,0,sizeof(buf));
+      buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      buf.memory = V4L2_MEMORY_MMAP;
+      buf.index = i;
+      if(xioctl(fd_,VIDIOC_QUERYBUF,&buf)<0){
+        close();
+        throw std::runtime_error("cannot query buffers of video device " + device);
+      }
+      void* start = mmap(NULL,buf.length,PROT_READ|PROT_WRITE,MAP_SHARED,fd_,buf.m.offset);
+      if(start==MAP_FAILED){
+        close();
+        throw std::runtime_error("cannot map buffers of video device " + device);
+      }
+      buffers_.push_back(start);
+      lengths_.push_back(buf.length);
+      if(xioctl(fd_,VIDIOC_QBUF,&buf)<0){
+        close();
+        throw std::runtime_error("cannot queue buffers of video device " + device);
+      }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(xioctl(fd_,VIDIOC_STREAMON,&type)<0){
+      close();
+      throw std::runtime_error("cannot start streaming on video device " + device);
+    }
+  }
+
+  V4l2Source::~V4l2Source(){
+    close();
+  }
+
+  void V4l2Source::close(){
+    if(fd_<0)
+      return;
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(fd_,VIDIOC_STREAMOFF,&type);
+    for(unsigned int i=0;i<buffers_.size();i++)
+      munmap(buffers_[i],lengths_[i]);
+    buffers_.clear();
+    lengths_.clear();
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+  const unsigned char* V4l2Source::grab(){
+    v4l2_buffer buf;
+    if(dequeued_>=0){
+      //the previous frame is not used anymore, give its buffer back to the driver
+      std::memset(&buf,0,sizeof(buf));
+      buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      buf.memory = V4L2_MEMORY_MMAP;
+      buf.index = dequeued_;
+      xioctl(fd_,VIDIOC_QBUF,&buf);
+      dequeued_ = -1;
+    }
+    std::memset(&buf,0,sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if(xioctl(fd_,VIDIOC_DQBUF,&buf)<0)
+      return NULL;
+    dequeued_ = buf.index;
+    timestamp_ = buf.timestamp.tv_sec*1000. + buf.timestamp.tv_usec/1000.;
+    return static_cast<const unsigned char*>(buffers_[buf.index]);
+  }
+}
+}
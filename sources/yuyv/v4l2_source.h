@@ -0,0 +1,30 @@
+#ifndef __YUYV_V4L2_SOURCE_H__
+#define __YUYV_V4L2_SOURCE_H__
+#include <string>
+#include <vector>
+
+#include "source.h"
+
+namespace sources{
+namespace yuyv{
+  /*
+   * YUYV capture from a V4L2 device through mmapped driver buffers.
+   * Frames are read in place from the dequeued buffer, which is handed back to the driver on the next grab.
+   */
+  class V4l2Source : public Source{
+  private:
+    int fd_;
+    std::vector<void*> buffers_;
+    std::vector<std::size_t> lengths_;
+    int dequeued_;
+    void close();
+  protected:
+    const unsigned char* grab();
+  public:
+    //throws std::runtime_error if the device cannot stream YUYV at this size
+    V4l2Source(const std::string& device, unsigned int width, unsigned int height, unsigned int nb_buffers = 3);
+    ~V4l2Source();
+  };
+}
+}
+#endif
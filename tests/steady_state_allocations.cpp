@@ -0,0 +1,175 @@
+/*
+ * Tracks the sample image of the data directory and checks that steady state TrackModel frames
+ * do not allocate: operator new is replaced by a counting one.
+ *
+ * Allocations made below the visp trackers' track() are whitelisted: visp builds its interaction
+ * matrices and moving edge lists on every call and the tracker cannot preallocate them.
+ * They are recognised from the call stack, which needs visp as a shared library.
+ * Detection frames are not steady state: zbar and libdmtx allocate, and so do the symbol payloads.
+ *
+ * usage: steady_state_allocations <data directory> [tracker options...]
+ * The options are given to the tracker after the defaults of the test, ctest runs it once per tracking path.
+ */
+#include "cmd_line/cmd_line.h"
+#include "detectors/datamatrix/detector.h"
+#include "libauto_tracker/tracking.h"
+#include "libauto_tracker/events.h"
+
+#include <visp/vpImageIo.h>
+#include <visp/vpMbEdgeTracker.h>
+#include <visp/vpMbKltTracker.h>
+#include <visp/vpMbEdgeKltTracker.h>
+
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace{
+  bool counting = false;      //only the frames under test are counted
+  bool inspecting = false;    //set while the call stack of an allocation is looked at
+  unsigned long allocations = 0;
+  unsigned long whitelisted = 0;
+
+  //mangled names of the visp calls allowed to allocate
+  const char* whitelist[] = {
+    "15vpMbEdgeTracker5trackERK7vpImageIhE",
+    "14vpMbKltTracker5trackERK7vpImageIhE",
+    "18vpMbEdgeKltTracker5trackERK7vpImageIhE"
+  };
+
+  bool below_whitelisted_call(){
+    void* frames[64];
+    int nb_frames = backtrace(frames,64);
+    for(int i=0;i<nb_frames;i++){
+      Dl_info info;
+      if(!dladdr(frames[i],&info) || !info.dli_sname)
+        continue;
+      for(unsigned int w=0;w<sizeof(whitelist)/sizeof(whitelist[0]);w++)
+        if(std::strstr(info.dli_sname,whitelist[w]))
+          return true;
+    }
+    return false;
+  }
+
+  void count(){
+    if(!counting || inspecting)
+      return;
+    inspecting = true;
+    if(below_whitelisted_call())
+      whitelisted++;
+    else
+      allocations++;
+    inspecting = false;
+  }
+
+  void* allocate(std::size_t size){
+    count();
+    void* p = std::malloc(size ? size : 1);
+    if(!p)
+      throw std::bad_alloc();
+    return p;
+  }
+}
+
+void* operator new(std::size_t size){
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size){
+  return allocate(size);
+}
+
+void operator delete(void* p){
+  std::free(p);
+}
+
+void operator delete[](void* p){
+  std::free(p);
+}
+
+int main(int argc, char** argv){
+  if(argc<2){
+    std::cerr << "usage: " << argv[0] << " <data directory> [tracker options...]" << std::endl;
+    return 1;
+  }
+  std::string data_dir = argv[1];
+  std::string config_file = data_dir + "config.cfg";
+  std::vector<std::string> args;
+  args.push_back(argv[0]);
+  args.push_back("--config-file");
+  args.push_back(config_file);
+  args.push_back("--data-directory");
+  args.push_back(data_dir);
+  args.push_back("--detector-type");
+  args.push_back("dmtx");
+  args.push_back("--tracker-type");
+  args.push_back("mbt");
+  args.push_back("--display");
+  args.push_back("0");
+  args.push_back("--verbose");
+  args.push_back("0");
+  //options of the run override the defaults above
+  std::vector<std::string> overrides(argv+2,argv+argc);
+  std::vector<char*> cargs;
+  for(unsigned int i=0;i<args.size();i++)
+    cargs.push_back(const_cast<char*>(args[i].c_str()));
+  CmdLine cmd((int)cargs.size(),&cargs[0],overrides);
+
+  vpImage<vpRGBa> I;
+  vpImageIo::read(I,data_dir + "pattern-1.png");
+  vpCameraParameters cam = cmd.get_cam_calib_params();
+
+  vpMbTracker* tracker = NULL;
+  if(cmd.get_tracker_type() == CmdLine::KLT)
+    tracker = new vpMbKltTracker();
+  else if(cmd.get_tracker_type() == CmdLine::KLT_MBT)
+    tracker = new vpMbEdgeKltTracker();
+  else
+    tracker = new vpMbEdgeTracker();
+
+  tracking::Tracker t(cmd,new detectors::datamatrix::Detector,tracker,false);
+  tracking::PoseSubscriber* poses = t.get_pose_publisher().subscribe();
+  t.start();
+  t.process_event(tracking::select_input(I));
+
+  //detection, model initialisation and the first tracked frames grow the per-frame buffers
+  const int warmup = 20, measured = 50;
+  int iter = 0;
+  tracking::pose_record_t record;
+  for(;iter<warmup;iter++)
+    t.process_event(tracking::input_ready(I,cam,iter));
+  if(!poses->latest(record) || record.state!=tracking::STATE_TRACK_MODEL || !record.valid){
+    std::cerr << "the model is not tracked after " << warmup << " frames" << std::endl;
+    return 1;
+  }
+  //warms up backtrace, which loads its unwinder on the first call
+  below_whitelisted_call();
+
+  int failed = 0;
+  for(;iter<warmup+measured;iter++){
+    allocations = whitelisted = 0;
+    counting = true;
+    t.process_event(tracking::input_ready(I,cam,iter));
+    counting = false;
+    if(!poses->latest(record) || record.state!=tracking::STATE_TRACK_MODEL || !record.valid){
+      std::cerr << "frame " << iter << ": tracking lost" << std::endl;
+      return 1;
+    }
+    if(allocations){
+      std::cerr << "frame " << iter << ": " << allocations << " allocations (" << whitelisted << " in visp)" << std::endl;
+      failed++;
+    }
+  }
+  t.process_event(tracking::finished());
+  if(failed){
+    std::cerr << failed << " of " << measured << " steady state frames allocated" << std::endl;
+    return 1;
+  }
+  std::cout << measured << " steady state frames without allocation" << std::endl;
+  return 0;
+}